@@ -1,4 +1,5 @@
 #include "XYZStage.h"
+#include "threadbudget.h"
 #include "utils.h"
 
 // Global variable definition
@@ -398,6 +399,8 @@ void XYZStage::move(double dx, double dy, double dz, double velocity_x, double v
 
 // This function runs in a separate thread, processing commands from the queue.
 void XYZStage::worker() {
+    pinCurrentThread(threadsForRole(ThreadRole::Stage));
+
     while (true) {
         MoveCommand currentCommand;
 
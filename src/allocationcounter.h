@@ -0,0 +1,12 @@
+#ifndef ALLOCATIONCOUNTER_H
+#define ALLOCATIONCOUNTER_H
+
+#include <cstddef>
+
+// Heap allocation counter for --self-test. Only builds with COUNT_ALLOCATIONS defined (Debug) replace
+// the global operator new/delete to count, release builds keep the default allocator and count nothing.
+// Sees allocations made by our own code, ORT and OpenCV allocate through their own DLL heaps.
+bool allocationCountingEnabled();
+size_t allocationCount();
+
+#endif // ALLOCATIONCOUNTER_H
@@ -0,0 +1,74 @@
+#include "asyncimagewriter.h"
+#include "utils.h"
+
+AsyncImageWriter::AsyncImageWriter(size_t maxQueued)
+    : m_stopWorker(false), m_maxQueued(maxQueued) {
+}
+
+AsyncImageWriter::~AsyncImageWriter() {
+    stop();
+}
+
+AsyncImageWriter& AsyncImageWriter::instance() {
+    static AsyncImageWriter writer;
+    return writer;
+}
+
+bool AsyncImageWriter::hasRoom() {
+    std::lock_guard<std::mutex> lock(m_queueMutex);
+    return !m_stopWorker && m_queue.size() < m_maxQueued;
+}
+
+bool AsyncImageWriter::enqueue(const std::string& path, const cv::Mat& image) {
+    {
+        std::lock_guard<std::mutex> lock(m_queueMutex);
+        if (m_stopWorker) return false;
+        if (!m_workerThread.joinable())
+            m_workerThread = std::thread(&AsyncImageWriter::worker, this);
+
+        if (m_queue.size() >= m_maxQueued) {
+            // never block the caller on disk IO
+            if (++m_dropped % 16 == 1)
+                LOG_WARNING("Image writer queue full, dropped " << m_dropped << " image(s) so far");
+            return false;
+        }
+        m_queue.push_back({ path, image });
+    }
+    m_condition.notify_one();
+    return true;
+}
+
+void AsyncImageWriter::stop() {
+    {
+        std::lock_guard<std::mutex> lock(m_queueMutex);
+        m_stopWorker = true;
+        if (!m_workerThread.joinable()) return;
+    }
+    m_condition.notify_one();
+    m_workerThread.join();
+}
+
+void AsyncImageWriter::worker() {
+    while (true) {
+        WriteRequest request;
+
+        {
+            std::unique_lock<std::mutex> lock(m_queueMutex);
+            m_condition.wait(lock, [this] {
+                return !m_queue.empty() || m_stopWorker;
+                });
+
+            // drain the queue before exiting so nothing queued is lost
+            if (m_stopWorker && m_queue.empty()) {
+                return;
+            }
+
+            request = std::move(m_queue.front());
+            m_queue.pop_front();
+        }
+
+        if (!cv::imwrite(request.path, request.image)) {
+            LOG_WARNING("Failed to write image: " << request.path);
+        }
+    }
+}
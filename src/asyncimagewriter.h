@@ -0,0 +1,51 @@
+#ifndef ASYNCIMAGEWRITER_H
+#define ASYNCIMAGEWRITER_H
+
+#include <opencv2/opencv.hpp>
+
+#include <string>
+#include <thread>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+// Background image writer for debug dumps. Images are queued by reference, callers that draw into an image
+// afterwards hand over a copy; a single worker thread does the encoding and disk IO. The thread starts with
+// the first image. The queue is bounded: when the disk can't keep up new images are dropped instead of
+// blocking the caller.
+class AsyncImageWriter {
+private:
+    struct WriteRequest {
+        std::string path;
+        cv::Mat image;
+    };
+
+    std::thread m_workerThread;
+    std::deque<WriteRequest> m_queue;
+    std::mutex m_queueMutex;
+    std::condition_variable m_condition;
+    std::atomic<bool> m_stopWorker;
+    size_t m_maxQueued;
+    size_t m_dropped = 0;
+
+    void worker();
+
+public:
+    explicit AsyncImageWriter(size_t maxQueued = 32);
+    ~AsyncImageWriter();
+
+    // shared writer used by the inference debug dumps
+    static AsyncImageWriter& instance();
+
+    // queues image as it is (shares its pixels), returns false if the queue is full and the image was dropped
+    bool enqueue(const std::string& path, const cv::Mat& image);
+
+    // whether an image queued now would be taken, lets callers skip preparing one that gets dropped
+    bool hasRoom();
+
+    // writes whatever is still queued and stops the worker thread, nothing to do if it never started
+    void stop();
+};
+
+#endif // ASYNCIMAGEWRITER_H
@@ -0,0 +1,28 @@
+#include "benchmarks.h"
+#include "inferenceworker.h"
+#include "utils.h"
+
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/imgproc.hpp>
+
+int runBenchmarks(const std::string& imagePath, const TileGridConfig& config) {
+    cv::Mat frame = cv::imread(imagePath);
+    if (frame.empty()) {
+        LOG_CRITICAL("[BENCH] Could not read " << imagePath);
+        return 1;
+    }
+    // frames reach the model as RGB, same as the camera path
+    cv::cvtColor(frame, frame, cv::COLOR_BGR2RGB);
+
+    InferenceWorker worker;
+    worker.setDrawResults(false);
+    worker.initialize();
+    if (!worker.isReady()) {
+        LOG_CRITICAL("[BENCH] No session, model expected at " << InferenceWorker::modelPathFor(worker.modelPrecision()));
+        return 1;
+    }
+
+    LOG_INFO("[BENCH] " << imagePath << " (" << frame.cols << "x" << frame.rows << ")");
+    worker.runBenchmarks(frame, config);
+    return 0;
+}
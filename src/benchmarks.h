@@ -0,0 +1,13 @@
+#ifndef BENCHMARKS_H
+#define BENCHMARKS_H
+
+#include <string>
+
+#include "tiling.h"
+
+// Runs every kernel and pipeline benchmark once on one image through a fresh macro session and logs
+// the [BENCH] lines, no camera or UI. Returns a process exit code, 0 when the model and image loaded.
+// Started with: Injector_app.exe --bench [image], without an image the replay source is used
+int runBenchmarks(const std::string& imagePath, const TileGridConfig& config = TileGridConfig());
+
+#endif // BENCHMARKS_H
@@ -1,7 +1,9 @@
 #include "cameraworker.h"
 #include <QThread>
 
-#include <filesystem>
+#include <algorithm>
+#include <cmath>
+#include "threadbudget.h"
 #include "utils.h"
 
 CameraWorker::CameraWorker(int camIndex, int camType,
@@ -11,6 +13,7 @@ CameraWorker::CameraWorker(int camIndex, int camType,
 {
     m_cameraIndex = camIndex;
     m_cameraType = camType;
+    m_fps = fps;
 
     LOG_INFO("CameraWorker initialized with camera index: " << m_cameraIndex
         << " and type: " << m_cameraType);
@@ -36,8 +39,17 @@ CameraWorker::CameraWorker(int camIndex, int camType,
             << " @ " << fps << " FPS");
     }
     else {
-        m_frameWidth = frameWidth;
-        m_frameHeight = frameHeight;
+        // no device: the replay source stands in for the camera, at its own resolution
+        const ReplaySourceConfig replay = replaySourceConfig();
+        if (m_replay.open(replay.path, replay.cacheBudgetMB * 1024 * 1024)) {
+            m_frameWidth = m_replay.frameSize().width;
+            m_frameHeight = m_replay.frameSize().height;
+        }
+        else {
+            m_frameWidth = frameWidth;
+            m_frameHeight = frameHeight;
+        }
+        if (replay.fps > 0) m_targetFps.store(replay.fps, std::memory_order_relaxed);
     }
 
     m_running = true;
@@ -64,6 +76,27 @@ void CameraWorker::start() {
 }
 
 void CameraWorker::process() {
+    // keeps capture off the inference cores when the thread budget pins threads
+    pinCurrentThread(threadsForRole(ThreadRole::Camera, m_cameraType));
+
+    // a camera paces the loop itself by blocking in grab(), the replay source has no device clock and
+    // is replayed at the target rate (the requested fps when none was set)
+    const bool deviceClocked = m_cameraIndex != IMG;
+    if (!deviceClocked && !m_replay.isOpened()) {
+        LOG_CRITICAL("Camera " << m_cameraType << " has no replay source, see ReplaySourceConfig");
+        return;
+    }
+    int64_t nextDueUs = steadyClockUs();
+
+    // per second: delivered frames, their spacing and, with fpsDebug, pool growth. Once the pools are
+    // warm the allocated count stays flat, --self-test checks that steady capture allocates no frames.
+    int loopFrames = 0;
+    int loopRateDropped = 0;
+    int64_t loopStartUs = steadyClockUs();
+    int64_t lastFrameUs = 0;
+    double intervalSumMs = 0.0, intervalSqSumMs = 0.0;
+    int intervals = 0;
+
     while (true) {
         {
             QMutexLocker locker(&m_mutex);
@@ -71,50 +104,114 @@ void CameraWorker::process() {
             if (!m_running) break;
         }
 
+        double targetFps = m_targetFps.load(std::memory_order_relaxed);
+        if (!deviceClocked && targetFps <= 0) targetFps = m_fps;
+        const int64_t periodUs = targetFps > 0 ? static_cast<int64_t>(1e6 / targetFps) : 0;
+
+        if (deviceClocked) {
+            // blocks until the device delivers the next frame. Grabbed even while a frame is held or
+            // rate limited, so the driver queue never fills with stale frames.
+            if (!m_cap.grab()) {
+                LOG_WARNING("Empty frame captured from camera");
+                QThread::msleep(10);
+                continue;
+            }
+        }
+        else {
+            const int64_t waitUs = nextDueUs - steadyClockUs();
+            if (waitUs > 0) QThread::usleep(static_cast<unsigned long>(waitUs));
+        }
+        const int64_t grabbedAtUs = steadyClockUs();
+
         cv::Mat frame;
-        cv::Mat resized;
 
         if (!m_capturedFrame.empty()) {
             frame = m_capturedFrame;
+            m_measuredFps.store(0.0f, std::memory_order_relaxed);
+            if (!deviceClocked) nextDueUs = grabbedAtUs + (periodUs > 0 ? periodUs : 50000);
             continue; // already rendered this frame
         }
         else {
-            if (m_cameraIndex == IMG) {
-                // TODO: make frame member of this class
-                std::string imgPath = "test_img.png";
-                if (!std::filesystem::exists(imgPath)) {
-                    LOG_CRITICAL("Test Image file does not exist: " << imgPath);
-                    return;
+            // target rate: frames arriving before their slot are dropped before decoding. A quarter
+            // period of slack keeps a camera running at about the target rate from losing every other frame.
+            if (periodUs > 0) {
+                if (grabbedAtUs + periodUs / 4 < nextDueUs) {
+                    ++loopRateDropped;
+                    continue;
                 }
+                // on schedule the slots stay evenly spaced, after a stall the schedule restarts from now
+                nextDueUs = grabbedAtUs - nextDueUs < periodUs ? nextDueUs + periodUs : grabbedAtUs + periodUs;
+            }
 
-                frame = cv::imread(imgPath);
-                //LOG_INFO("Reading image: " << imgPath << "dims: " << frame.cols << "x" << frame.rows);
+            cv::Mat source;
+            if (m_cameraIndex == IMG) {
+                // decoded once, replayed from memory (read-only, shared with the replay cache)
+                m_replay.read(source);
             }
-            else
-                m_cap >> frame;
+            else {
+                // same size every frame, the backend decodes into the buffer it already has
+                m_cap.retrieve(m_captureBuffer);
+                source = m_captureBuffer;
+            }
+            // stamped when the frame was grabbed, decode and conversion count towards its age
+            const int64_t capturedAtMs = grabbedAtUs / 1000;
 
-            if (frame.empty()) {
+            if (source.empty()) {
                 //std::cerr << "something wrong" << std::endl;
                 LOG_WARNING("Empty frame captured from camera");
                 continue;
             }
+            std::shared_ptr<LatestFrameSlot> liveSlot;
+            {
+                QMutexLocker locker(&m_mutex);
+                liveSlot = m_liveSlot;
+            }
+            const bool capture = getCaptureImg();
 
             //cv::flip(frame, frame, 1);
-            cv::cvtColor(frame, frame, cv::COLOR_BGR2RGB);
+            // full resolution only when something needs it: a capture or the live detector
+            cv::Mat preview;
+            m_outputs.convert(source, capture || liveSlot, m_previewScale.load(std::memory_order_relaxed), frame, preview);
 
-            if (getCaptureImg() || m_cameraIndex == IMG) {
+            if (capture) {
                 LOG_INFO("Captured frame");
                 setCapturedFrame(frame);
             }
 
-            // for large images, resizing helps with UI FPS
-            /*if (frame.cols > 1280 || frame.rows > 720)
-                cv::resize(frame, frame, cv::Size(1280, 720));*/
+            // the pool never hands out a buffer that is still referenced, so the detector can hold on to it without a copy
+            if (liveSlot) liveSlot->put(frame, capturedAtMs);
 
-            QImage qImage(frame.data, frame.cols, frame.rows, frame.step, QImage::Format_RGB888);
-            emit frameReady(qImage.copy(), m_cameraType);
+            // the UI picks up the newest frame on its next tick, capture never waits for it
+            if (m_frames) m_frames->publish(preview, capturedAtMs, source.size());
 
-            QThread::msleep(50);
+            ++loopFrames;
+            if (lastFrameUs > 0) {
+                const double intervalMs = (grabbedAtUs - lastFrameUs) / 1000.0;
+                intervalSumMs += intervalMs;
+                intervalSqSumMs += intervalMs * intervalMs;
+                ++intervals;
+            }
+            lastFrameUs = grabbedAtUs;
+
+            const int64_t nowUs = steadyClockUs();
+            if (nowUs - loopStartUs >= 1000000) {
+                const double meanMs = intervals ? intervalSumMs / intervals : 0.0;
+                const double jitterMs = intervals ? std::sqrt(std::max(0.0, intervalSqSumMs / intervals - meanMs * meanMs)) : 0.0;
+                m_measuredFps.store(static_cast<float>(loopFrames * 1e6 / (nowUs - loopStartUs)), std::memory_order_relaxed);
+                m_jitterMs.store(static_cast<float>(jitterMs), std::memory_order_relaxed);
+
+                if (get_fpsDebug_flag())
+                    LOG_INFO("Camera " << m_cameraType << ": " << loopFrames << " frames, interval " << meanMs << " +- " << jitterMs
+                        << " ms, " << loopRateDropped << " dropped by rate limit, pools " << m_outputs.framePool().size() << " full + "
+                        << m_outputs.previewPool().size() << " preview buffers ("
+                        << m_outputs.framePool().allocations() + m_outputs.previewPool().allocations() << " allocated)");
+
+                loopFrames = 0;
+                loopRateDropped = 0;
+                intervalSumMs = intervalSqSumMs = 0.0;
+                intervals = 0;
+                loopStartUs = steadyClockUs();
+            }
         }
     }
-}
\ No newline at end of file
+}
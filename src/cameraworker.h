@@ -2,10 +2,16 @@
 #define CAMERAWORKER_H
 
 #include <QObject>
-#include <QImage>
 #include <QMutex>
 #include <opencv2/opencv.hpp>
 
+#include <atomic>
+#include <memory>
+
+#include "captureoutputs.h"
+#include "latestframe.h"
+#include "replaysource.h"
+#include "triplebuffer.h"
 #include "utils.h"
 
 class CameraWorker : public QObject {
@@ -28,13 +34,25 @@ public:
 	// TODO: even after capture macro img reads from the camera, we still need this to show the video feed captured frame to the user
     void setCapturedFrame(cv::Mat& frame) { m_capturedFrame = frame.clone(); }
     cv::Mat getCaturedFrame() { QMutexLocker lock(&m_mutex); return m_capturedFrame; }
+
+    // every frame is also offered to the live detector through this slot, nullptr stops it
+    void setLiveSlot(std::shared_ptr<LatestFrameSlot> slot) { QMutexLocker lock(&m_mutex); m_liveSlot = std::move(slot); }
+    // preview frames go to the UI through this buffer, set before the thread starts
+    void setFrameBuffer(std::shared_ptr<TripleFrameBuffer> frames) { m_frames = std::move(frames); }
+
+    // Caps delivered frames at fps, 0 = every frame the camera delivers. Frames above the rate are
+    // grabbed and dropped undecoded. The replay source (IMG) runs at the constructor's fps unless set.
+    void setTargetFps(double fps) { m_targetFps.store(fps, std::memory_order_relaxed); }
+    // Preview resolution relative to the captured frame, the UI sets it to the view's current zoom.
+    // Only the downscaled preview goes to the UI, full frames are converted for captures and live detection.
+    void setPreviewScale(double scale) { m_previewScale.store(scale, std::memory_order_relaxed); }
+    // measured over the last second of delivered frames, readable from any thread
+    float measuredFps() const { return m_measuredFps.load(std::memory_order_relaxed); }
+    float frameJitterMs() const { return m_jitterMs.load(std::memory_order_relaxed); } // std dev of the frame interval
  
 public slots:
     void process();
 
-signals:
-    void frameReady(const QImage& image, int cameraType);
-
 private:
     cv::VideoCapture m_cap;
     bool m_running;
@@ -43,8 +61,20 @@ private:
     int m_cameraType;
     int m_frameWidth;
     int m_frameHeight;
+    int m_fps;
     bool m_captureImg;
     cv::Mat m_capturedFrame;
+    std::shared_ptr<LatestFrameSlot> m_liveSlot;
+    std::shared_ptr<TripleFrameBuffer> m_frames;
+
+    cv::Mat m_captureBuffer; // BGR frame from the camera, reused every iteration
+    ReplaySource m_replay;   // IMG mode: image, frame directory or video instead of a device
+    CaptureOutputs m_outputs; // pooled RGB frames and previews
+
+    std::atomic<double> m_targetFps{ 0.0 };
+    std::atomic<double> m_previewScale{ 1.0 };
+    std::atomic<float> m_measuredFps{ 0.0f };
+    std::atomic<float> m_jitterMs{ 0.0f };
 };
 
 
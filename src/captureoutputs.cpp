@@ -0,0 +1,39 @@
+#include "captureoutputs.h"
+
+#include <opencv2/imgproc.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+void CaptureOutputs::convert(const cv::Mat& source, bool fullFrame, double previewScale, cv::Mat& frame, cv::Mat& preview) {
+    // converted straight into a pooled buffer no one else holds anymore
+    frame.release();
+    if (fullFrame) {
+        frame = m_framePool.acquire(source.size(), source.type());
+        cv::cvtColor(source, frame, cv::COLOR_BGR2RGB);
+    }
+
+    const double scale = std::min(1.0, previewScale);
+    const cv::Size size(std::max(1, static_cast<int>(std::lround(source.cols * scale))),
+        std::max(1, static_cast<int>(std::lround(source.rows * scale))));
+
+    if (size == source.size()) {
+        if (!frame.empty()) {
+            preview = frame;
+            return;
+        }
+        preview = m_previewPool.acquire(size, source.type());
+        cv::cvtColor(source, preview, cv::COLOR_BGR2RGB);
+        return;
+    }
+
+    // area downscale first, the color conversion then only touches the preview's pixels
+    preview = m_previewPool.acquire(size, source.type());
+    if (!frame.empty()) {
+        cv::resize(frame, preview, size, 0, 0, cv::INTER_AREA);
+    }
+    else {
+        cv::resize(source, m_previewBuffer, size, 0, 0, cv::INTER_AREA);
+        cv::cvtColor(m_previewBuffer, preview, cv::COLOR_BGR2RGB);
+    }
+}
@@ -0,0 +1,26 @@
+#ifndef CAPTUREOUTPUTS_H
+#define CAPTUREOUTPUTS_H
+
+#include <opencv2/core.hpp>
+
+#include "framepool.h"
+
+// What a capture loop makes of each BGR frame it grabs: the RGB preview for the UI and, when a capture
+// or the live detector needs it, the full resolution RGB frame. Both come from frame pools, so once
+// the pools are warm a frame costs no allocation.
+class CaptureOutputs {
+public:
+    // fullFrame: also convert the full resolution frame into frame, otherwise frame is released.
+    // previewScale is relative to the source, 1 = the preview is the full frame.
+    void convert(const cv::Mat& source, bool fullFrame, double previewScale, cv::Mat& frame, cv::Mat& preview);
+
+    const FramePool& framePool() const { return m_framePool; }
+    const FramePool& previewPool() const { return m_previewPool; }
+
+private:
+    FramePool m_framePool;   // full resolution RGB frames for captures and the detector
+    FramePool m_previewPool; // RGB previews handed to the UI
+    cv::Mat m_previewBuffer; // downscaled BGR source, reused every frame
+};
+
+#endif // CAPTUREOUTPUTS_H
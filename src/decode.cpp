@@ -0,0 +1,281 @@
+#include "decode.h"
+#include "utils.h"
+
+#include <opencv2/core.hpp>
+
+#include <chrono>
+#include <cstdlib>
+#include <immintrin.h>
+
+// MSVC lets any TU use AVX2 intrinsics, GCC/Clang need the target enabled per function
+#if defined(__GNUC__) || defined(__clang__)
+#define TARGET_SSE41 __attribute__((target("sse4.1")))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define TARGET_SSE41
+#define TARGET_AVX2
+#endif
+
+namespace {
+
+// Box rows are only read for anchors that made it past the threshold
+inline void emitCandidate(const float* output, int numPredictions, int i, float score, int classId,
+    DetectionCandidates& c) {
+    const int k = c.count++;
+    c.cx[k] = output[i];
+    c.cy[k] = output[numPredictions + i];
+    c.w[k] = output[2 * numPredictions + i];
+    c.h[k] = output[3 * numPredictions + i];
+    c.scores[k] = score;
+    c.classIds[k] = classId;
+}
+
+// Kernels are templated on the class count: 0 reads it from channels at runtime, a fixed count lets
+// the compiler unroll the class loop and keep the running max/argmax in registers.
+// Same as the SIMD lanes: first class wins ties, strict > threshold
+template <int NumClasses>
+void decodeRange(const float* output, int channels, int numPredictions, int begin, int end, float threshold,
+    DetectionCandidates& c) {
+    const int numClasses = NumClasses > 0 ? NumClasses : channels - 4;
+    const float* scores = output + 4 * numPredictions;
+
+    for (int i = begin; i < end; ++i) {
+        float best = scores[i];
+        int bestId = 0;
+        for (int cls = 1; cls < numClasses; ++cls) {
+            float s = scores[cls * numPredictions + i];
+            if (s > best) {
+                best = s;
+                bestId = cls;
+            }
+        }
+        if (best > threshold)
+            emitCandidate(output, numPredictions, i, best, bestId, c);
+    }
+}
+
+template <int NumClasses>
+void decodeScalar(const float* output, int channels, int numPredictions, float threshold, DetectionCandidates& c) {
+    decodeRange<NumClasses>(output, channels, numPredictions, 0, numPredictions, threshold, c);
+}
+
+template <int NumClasses>
+TARGET_SSE41 void decodeSSE41(const float* output, int channels, int numPredictions, float threshold,
+    DetectionCandidates& c) {
+    const int numClasses = NumClasses > 0 ? NumClasses : channels - 4;
+    const float* scores = output + 4 * numPredictions;
+    const __m128 thr = _mm_set1_ps(threshold);
+
+    int i = 0;
+    for (; i + 4 <= numPredictions; i += 4) {
+        __m128 best = _mm_loadu_ps(scores + i);
+        __m128i bestId = _mm_setzero_si128();
+        for (int cls = 1; cls < numClasses; ++cls) {
+            __m128 s = _mm_loadu_ps(scores + cls * numPredictions + i);
+            __m128 gt = _mm_cmpgt_ps(s, best);
+            best = _mm_blendv_ps(best, s, gt);
+            bestId = _mm_blendv_epi8(bestId, _mm_set1_epi32(cls), _mm_castps_si128(gt));
+        }
+
+        int mask = _mm_movemask_ps(_mm_cmpgt_ps(best, thr));
+        if (!mask) continue;
+
+        alignas(16) float bestScores[4];
+        alignas(16) int bestIds[4];
+        _mm_store_ps(bestScores, best);
+        _mm_store_si128(reinterpret_cast<__m128i*>(bestIds), bestId);
+        for (int lane = 0; lane < 4; ++lane)
+            if (mask & (1 << lane))
+                emitCandidate(output, numPredictions, i + lane, bestScores[lane], bestIds[lane], c);
+    }
+    decodeRange<NumClasses>(output, channels, numPredictions, i, numPredictions, threshold, c);
+}
+
+template <int NumClasses>
+TARGET_AVX2 void decodeAVX2(const float* output, int channels, int numPredictions, float threshold,
+    DetectionCandidates& c) {
+    const int numClasses = NumClasses > 0 ? NumClasses : channels - 4;
+    const float* scores = output + 4 * numPredictions;
+    const __m256 thr = _mm256_set1_ps(threshold);
+
+    int i = 0;
+    for (; i + 8 <= numPredictions; i += 8) {
+        __m256 best = _mm256_loadu_ps(scores + i);
+        __m256i bestId = _mm256_setzero_si256();
+        for (int cls = 1; cls < numClasses; ++cls) {
+            __m256 s = _mm256_loadu_ps(scores + cls * numPredictions + i);
+            __m256 gt = _mm256_cmp_ps(s, best, _CMP_GT_OQ);
+            best = _mm256_blendv_ps(best, s, gt);
+            bestId = _mm256_blendv_epi8(bestId, _mm256_set1_epi32(cls), _mm256_castps_si256(gt));
+        }
+
+        // nearly every anchor is background, those blocks end here
+        int mask = _mm256_movemask_ps(_mm256_cmp_ps(best, thr, _CMP_GT_OQ));
+        if (!mask) continue;
+
+        alignas(32) float bestScores[8];
+        alignas(32) int bestIds[8];
+        _mm256_store_ps(bestScores, best);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(bestIds), bestId);
+        for (int lane = 0; lane < 8; ++lane)
+            if (mask & (1 << lane))
+                emitCandidate(output, numPredictions, i + lane, bestScores[lane], bestIds[lane], c);
+    }
+    decodeRange<NumClasses>(output, channels, numPredictions, i, numPredictions, threshold, c);
+}
+
+typedef void (*DecodeFn)(const float* output, int channels, int numPredictions, float threshold, DetectionCandidates& c);
+
+enum class DecodeIsa { Scalar, SSE41, AVX2 };
+
+template <int NumClasses>
+DecodeFn decodeFor(DecodeIsa isa) {
+    switch (isa) {
+    case DecodeIsa::AVX2: return decodeAVX2<NumClasses>;
+    case DecodeIsa::SSE41: return decodeSSE41<NumClasses>;
+    default: return decodeScalar<NumClasses>;
+    }
+}
+
+// Instantiated ahead of time for the class counts we ship (ce/clump = 2) and single-class models,
+// anything else takes the runtime-count fallback
+struct DecodeKernel {
+    const char* name;
+    DecodeFn oneClass;
+    DecodeFn twoClasses;
+    DecodeFn generic;
+
+    DecodeFn forClasses(int numClasses) const {
+        switch (numClasses) {
+        case 1: return oneClass;
+        case 2: return twoClasses;
+        default: return generic;
+        }
+    }
+};
+
+DecodeKernel makeKernel(const char* name, DecodeIsa isa) {
+    return DecodeKernel{ name, decodeFor<1>(isa), decodeFor<2>(isa), decodeFor<0>(isa) };
+}
+
+const DecodeKernel& selectKernel() {
+    static const DecodeKernel kernel = [] {
+        if (cv::checkHardwareSupport(CV_CPU_AVX2))
+            return makeKernel("AVX2", DecodeIsa::AVX2);
+        if (cv::checkHardwareSupport(CV_CPU_SSE4_1))
+            return makeKernel("SSE4.1", DecodeIsa::SSE41);
+        return makeKernel("scalar", DecodeIsa::Scalar);
+    }();
+    return kernel;
+}
+
+} // namespace
+
+
+void DetectionCandidates::reserve(int capacity) {
+    if (static_cast<int>(scores.size()) >= capacity) return;
+    cx.resize(capacity);
+    cy.resize(capacity);
+    w.resize(capacity);
+    h.resize(capacity);
+    scores.resize(capacity);
+    classIds.resize(capacity);
+}
+
+const char* decodeKernelName() {
+    return selectKernel().name;
+}
+
+void decodePredictions(const float* output, int channels, int numPredictions, float threshold,
+    DetectionCandidates& candidates) {
+    // every anchor could pass, so size for the worst case once and write by index
+    candidates.reserve(numPredictions);
+    candidates.clear();
+    if (channels <= 4) return;
+
+    selectKernel().forClasses(channels - 4)(output, channels, numPredictions, threshold, candidates);
+}
+
+void decodePredictionsGeneric(const float* output, int channels, int numPredictions, float threshold,
+    DetectionCandidates& candidates) {
+    candidates.reserve(numPredictions);
+    candidates.clear();
+    if (channels <= 4) return;
+
+    selectKernel().generic(output, channels, numPredictions, threshold, candidates);
+}
+
+bool decodeIsSpecialized(int channels) {
+    const DecodeKernel& kernel = selectKernel();
+    return kernel.forClasses(channels - 4) != kernel.generic;
+}
+
+void decodePredictionsReference(const float* output, int channels, int numPredictions, float threshold,
+    DetectionCandidates& candidates) {
+    candidates.reserve(numPredictions);
+    candidates.clear();
+
+    for (int i = 0; i < numPredictions; ++i) {
+        float maxClassScore = 0.0f;
+        int maxClassId = 0;
+
+        for (int j = 4; j < channels; ++j) {
+            float score = output[j * numPredictions + i];
+            if (score > maxClassScore) {
+                maxClassScore = score;
+                maxClassId = j - 4;
+            }
+        }
+
+        if (maxClassScore > threshold)
+            emitCandidate(output, numPredictions, i, maxClassScore, maxClassId, candidates);
+    }
+}
+
+void benchmarkDecode(const float* output, int batchSize, int channels, int numPredictions, float threshold,
+    int iterations) {
+    if (batchSize <= 0 || iterations <= 0) return;
+
+    const size_t imageSize = static_cast<size_t>(channels) * numPredictions;
+    std::vector<DetectionCandidates> reference(batchSize);
+    std::vector<DetectionCandidates> simd(batchSize);
+
+    auto timeRuns = [&](auto&& fn, std::vector<DetectionCandidates>& out) {
+        // first run sizes the candidate buffers
+        for (int b = 0; b < batchSize; ++b)
+            fn(output + b * imageSize, channels, numPredictions, threshold, out[b]);
+
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int it = 0; it < iterations; ++it)
+            for (int b = 0; b < batchSize; ++b)
+                fn(output + b * imageSize, channels, numPredictions, threshold, out[b]);
+        auto end = std::chrono::high_resolution_clock::now();
+        return std::chrono::duration<double, std::milli>(end - start).count() / iterations;
+    };
+
+    std::vector<DetectionCandidates> generic(batchSize);
+    double referenceMs = timeRuns(decodePredictionsReference, reference);
+    double genericMs = timeRuns(decodePredictionsGeneric, generic);
+    double simdMs = timeRuns(decodePredictions, simd);
+
+    // both keep anchors in order, so matching candidates line up index by index
+    int total = 0;
+    int mismatches = 0;
+    for (int b = 0; b < batchSize; ++b) {
+        const DetectionCandidates& r = reference[b];
+        const DetectionCandidates& s = simd[b];
+        total += s.count;
+        if (r.count != s.count) {
+            mismatches += std::abs(r.count - s.count);
+            continue;
+        }
+        for (int k = 0; k < r.count; ++k)
+            if (r.scores[k] != s.scores[k] || r.classIds[k] != s.classIds[k] || r.cx[k] != s.cx[k] || r.cy[k] != s.cy[k])
+                ++mismatches;
+    }
+
+    LOG_INFO("[BENCH] decode " << batchSize << "x" << numPredictions << " predictions (" << channels - 4
+        << " classes): reference " << referenceMs << " ms, SIMD (" << decodeKernelName() << ") runtime class count "
+        << genericMs << " ms, " << (decodeIsSpecialized(channels) ? "fixed class count " : "no specialization, ") << simdMs
+        << " ms, speedup " << referenceMs / simdMs << "x, " << total << " candidates, " << mismatches << " mismatches");
+}
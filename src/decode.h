@@ -0,0 +1,43 @@
+#ifndef DECODE_H
+#define DECODE_H
+
+#include <vector>
+
+
+// Structure-of-arrays candidate buffer in model input coordinates. Storage only grows, so once it
+// has seen a full prediction row decoding into it never allocates.
+struct DetectionCandidates {
+    std::vector<float> cx, cy, w, h;
+    std::vector<float> scores;
+    std::vector<int> classIds;
+    int count = 0;
+
+    void reserve(int capacity);
+    void clear() { count = 0; }
+};
+
+// Decodes one image of a channel-major YOLO output [4 + classes, numPredictions]: SIMD max/argmax
+// over the class rows, anchors at or below threshold are rejected before their box rows are read.
+// Dispatches to a kernel compiled for the class count when there is one. Replaces the contents of candidates.
+void decodePredictions(const float* output, int channels, int numPredictions, float threshold,
+    DetectionCandidates& candidates);
+
+// Same SIMD kernel with the class count read at runtime, the fallback for models without a specialization
+void decodePredictionsGeneric(const float* output, int channels, int numPredictions, float threshold,
+    DetectionCandidates& candidates);
+
+// True when decodePredictions has a kernel compiled for this class count (1 and 2 classes)
+bool decodeIsSpecialized(int channels);
+
+// Old one-anchor-at-a-time loop, kept to validate and benchmark the SIMD decoder
+void decodePredictionsReference(const float* output, int channels, int numPredictions, float threshold,
+    DetectionCandidates& candidates);
+
+// Name of the SIMD variant picked at runtime ("AVX2", "SSE4.1" or "scalar")
+const char* decodeKernelName();
+
+// Times the reference and SIMD decoders over a whole batch of outputs and logs the results
+void benchmarkDecode(const float* output, int batchSize, int channels, int numPredictions, float threshold,
+    int iterations = 10);
+
+#endif // DECODE_H
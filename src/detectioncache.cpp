@@ -0,0 +1,156 @@
+#include "detectioncache.h"
+#include "utils.h"
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+namespace {
+
+const char SIDECAR_MAGIC[4] = { 'D', 'E', 'T', '1' };
+const uint32_t MAX_SIDECAR_ENTRIES = 1 << 20; // sanity bound for damaged files
+
+struct BoxRecord {
+    int32_t x, y, width, height;
+    int32_t classId;
+    float score;
+};
+
+struct RectRecord {
+    int32_t x, y, width, height;
+};
+
+inline uint64_t mix(uint64_t hash, uint64_t word) {
+    hash = (hash ^ word) * 0x9E3779B97F4A7C15ull;
+    return hash ^ (hash >> 29);
+}
+
+template <typename T>
+void writeValue(std::ofstream& out, const T& value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+bool readValue(std::ifstream& in, T& value) {
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(T)));
+}
+
+} // namespace
+
+
+uint64_t hashBytes(uint64_t hash, const void* data, size_t size) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t word;
+        std::memcpy(&word, bytes + i, 8);
+        hash = mix(hash, word);
+    }
+    uint64_t tail = 0;
+    if (size > i) std::memcpy(&tail, bytes + i, size - i);
+    return mix(hash, tail ^ (static_cast<uint64_t>(size) << 56));
+}
+
+uint64_t imageContentHash(const cv::Mat& image) {
+    const int header[] = { image.rows, image.cols, image.type() };
+    uint64_t hash = hashBytes(0, header, sizeof(header));
+
+    // row by row, a cropped view hashes the same as a continuous copy of it
+    const size_t rowBytes = image.cols * image.elemSize();
+    for (int y = 0; y < image.rows; ++y)
+        hash = hashBytes(hash, image.ptr(y), rowBytes);
+    return hash;
+}
+
+std::string DetectionCache::sidecarPath(uint64_t contentHash, uint64_t settingsHash) const {
+    char name[48];
+    std::snprintf(name, sizeof(name), "%016llx_%016llx.det",
+        static_cast<unsigned long long>(contentHash), static_cast<unsigned long long>(settingsHash));
+    return (std::filesystem::path(m_directory) / name).string();
+}
+
+bool DetectionCache::load(uint64_t contentHash, uint64_t settingsHash, DetectionResult& detections) const {
+    if (!enabled()) return false;
+
+    std::ifstream in(sidecarPath(contentHash, settingsHash), std::ios::binary);
+    if (!in) return false;
+
+    char magic[4];
+    uint64_t storedContent = 0, storedSettings = 0;
+    uint32_t count = 0;
+    if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, SIDECAR_MAGIC, sizeof(magic)) != 0 ||
+        !readValue(in, storedContent) || !readValue(in, storedSettings) || !readValue(in, count) ||
+        storedContent != contentHash || storedSettings != settingsHash || count > MAX_SIDECAR_ENTRIES) {
+        LOG_WARNING("Ignoring damaged detection cache file " << sidecarPath(contentHash, settingsHash));
+        return false;
+    }
+
+    std::vector<BoxRecord> boxes(count);
+    uint32_t pathCount = 0;
+    if (!in.read(reinterpret_cast<char*>(boxes.data()), count * sizeof(BoxRecord)) ||
+        !readValue(in, pathCount) || pathCount > MAX_SIDECAR_ENTRIES) {
+        LOG_WARNING("Ignoring truncated detection cache file " << sidecarPath(contentHash, settingsHash));
+        return false;
+    }
+    std::vector<RectRecord> path(pathCount);
+    if (!in.read(reinterpret_cast<char*>(path.data()), pathCount * sizeof(RectRecord))) {
+        LOG_WARNING("Ignoring truncated detection cache file " << sidecarPath(contentHash, settingsHash));
+        return false;
+    }
+
+    detections = DetectionResult();
+    for (const BoxRecord& box : boxes) {
+        detections.boxes.emplace_back(box.x, box.y, box.width, box.height);
+        detections.classIds.push_back(box.classId);
+        detections.scores.push_back(box.score);
+    }
+    for (const RectRecord& rect : path)
+        detections.path.emplace_back(rect.x, rect.y, rect.width, rect.height);
+    return true;
+}
+
+bool DetectionCache::store(uint64_t contentHash, uint64_t settingsHash, const DetectionResult& detections) const {
+    if (!enabled()) return false;
+
+    std::error_code ec;
+    std::filesystem::create_directories(m_directory, ec);
+
+    // complete file or none: written aside and renamed into place
+    const std::string path = sidecarPath(contentHash, settingsHash);
+    const std::string tempPath = path + ".tmp";
+    {
+        std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            LOG_WARNING("Could not write detection cache file " << path);
+            return false;
+        }
+
+        out.write(SIDECAR_MAGIC, sizeof(SIDECAR_MAGIC));
+        writeValue(out, contentHash);
+        writeValue(out, settingsHash);
+        writeValue(out, static_cast<uint32_t>(detections.boxes.size()));
+        for (size_t i = 0; i < detections.boxes.size(); ++i) {
+            const cv::Rect& box = detections.boxes[i];
+            writeValue(out, BoxRecord{ box.x, box.y, box.width, box.height, detections.classIds[i], detections.scores[i] });
+        }
+        writeValue(out, static_cast<uint32_t>(detections.path.size()));
+        for (const cv::Rect& rect : detections.path)
+            writeValue(out, RectRecord{ rect.x, rect.y, rect.width, rect.height });
+
+        if (!out) {
+            LOG_WARNING("Could not write detection cache file " << path);
+            out.close();
+            std::filesystem::remove(tempPath, ec);
+            return false;
+        }
+    }
+
+    std::filesystem::rename(tempPath, path, ec);
+    if (ec) {
+        LOG_WARNING("Could not store detection cache file " << path << ": " << ec.message());
+        std::filesystem::remove(tempPath, ec);
+        return false;
+    }
+    return true;
+}
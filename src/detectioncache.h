@@ -0,0 +1,49 @@
+#ifndef DETECTIONCACHE_H
+#define DETECTIONCACHE_H
+
+#include <opencv2/core.hpp>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Final detections of one image: NMS survivors (best first) and the traversal path through them
+struct DetectionResult {
+    std::vector<cv::Rect> boxes;
+    std::vector<int> classIds;
+    std::vector<float> scores;
+    std::vector<cv::Rect> path;
+
+    // keeps the capacity, so a result reused across predictions stops allocating once warm
+    void clear() {
+        boxes.clear();
+        classIds.clear();
+        scores.clear();
+        path.clear();
+    }
+};
+
+// 64-bit hash of the pixels, size and type. Same image = same key, wherever it was loaded from.
+uint64_t imageContentHash(const cv::Mat& image);
+
+// Mixes size bytes into hash, used to fold model id, thresholds and tiling into one settings key
+uint64_t hashBytes(uint64_t hash, const void* data, size_t size);
+
+// Detection results stored as small binary sidecars (<content>_<settings>.det) in directory.
+// A file only matches when both keys match, so a new model or different thresholds never reuse
+// an old result. Empty directory = disabled.
+class DetectionCache {
+public:
+    void setDirectory(const std::string& directory) { m_directory = directory; }
+    bool enabled() const { return !m_directory.empty(); }
+
+    bool load(uint64_t contentHash, uint64_t settingsHash, DetectionResult& detections) const;
+    bool store(uint64_t contentHash, uint64_t settingsHash, const DetectionResult& detections) const;
+
+private:
+    std::string sidecarPath(uint64_t contentHash, uint64_t settingsHash) const;
+
+    std::string m_directory;
+};
+
+#endif // DETECTIONCACHE_H
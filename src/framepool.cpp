@@ -0,0 +1,26 @@
+#include "framepool.h"
+#include "utils.h"
+
+cv::Mat FramePool::acquire(const cv::Size& size, int type) {
+    if (!m_buffers.empty() && (m_buffers.front().size() != size || m_buffers.front().type() != type)) {
+        LOG_INFO("Frame pool resized to " << size.width << "x" << size.height);
+        m_buffers.clear();
+    }
+
+    // the pool's own reference is the only one left: every consumer is done with this buffer.
+    // Consumers drop theirs on other threads, so the count is read atomically.
+    for (cv::Mat& buffer : m_buffers) {
+        if (CV_XADD(&buffer.u->refcount, 0) == 1)
+            return buffer;
+    }
+
+    ++m_allocations;
+    cv::Mat buffer(size, type);
+    if (m_buffers.size() < m_capacity) {
+        m_buffers.push_back(buffer);
+    } else if (!m_exhaustedLogged) {
+        LOG_WARNING("Frame pool of " << m_capacity << " buffers exhausted, allocating unpooled frames");
+        m_exhaustedLogged = true;
+    }
+    return buffer;
+}
@@ -0,0 +1,32 @@
+#ifndef FRAMEPOOL_H
+#define FRAMEPOOL_H
+
+#include <opencv2/core.hpp>
+
+#include <cstddef>
+#include <vector>
+
+// Fixed set of frame buffers recycled by one capture loop. A buffer is handed out again only once
+// every consumer (UI buffer, live detector slot, ...) has dropped its reference to it, so frames can
+// be passed on by reference count and are never written while someone still reads them.
+// Grows lazily up to capacity, a pool that is still short after that allocates unpooled frames.
+class FramePool {
+public:
+    explicit FramePool(size_t capacity = 6) : m_capacity(capacity) {}
+
+    // Buffer of exactly size and type that nobody else references. A new size (renegotiated
+    // resolution) drops the old buffers.
+    cv::Mat acquire(const cv::Size& size, int type);
+
+    size_t size() const { return m_buffers.size(); }
+    // buffers allocated since construction, stops growing once the pool is warm
+    size_t allocations() const { return m_allocations; }
+
+private:
+    std::vector<cv::Mat> m_buffers;
+    size_t m_capacity;
+    size_t m_allocations = 0;
+    bool m_exhaustedLogged = false;
+};
+
+#endif // FRAMEPOOL_H
@@ -1,14 +1,40 @@
 #include "inferenceworker.h"
 #include "inferenceworker.h"
+#include "preprocess.h"
+#include "asyncimagewriter.h"
 #include "utils.h"
 
-InferenceWorker::InferenceWorker(int frameWidth, int frameHeight, cv::Mat& img) {
-    m_frameWidth = frameWidth;
-    m_frameHeight = frameHeight;
-    m_inputFrame = img;
-    
-    // Initialize ONNX Runtime
-    initializeONNXRuntime();
+#include <onnxruntime_session_options_config_keys.h>
+
+#include <algorithm>
+
+// micro-batch counts tried by the online tuner, 1 is the single-shot Run
+static const int MICRO_BATCH_CANDIDATES[] = { 1, 2, 3, 4 };
+static const int NUM_MICRO_BATCH_CANDIDATES = sizeof(MICRO_BATCH_CANDIDATES) / sizeof(MICRO_BATCH_CANDIDATES[0]);
+// the first run at a new batch shape pays for ORT's shape setup, only the last run of a candidate counts
+static const int TUNING_RUNS = 2;
+
+// Runs on an ORT pool thread when a micro-batch finishes
+static void onMicroBatchDone(void* userData, OrtValue** /*outputs*/, size_t /*numOutputs*/, OrtStatusPtr status) {
+    MicroBatch* batch = static_cast<MicroBatch*>(userData);
+    Ort::Status result(status); // takes ownership
+    std::lock_guard<std::mutex> lock(batch->mutex);
+    if (!result.IsOK()) batch->error = result.GetErrorMessage();
+    batch->finished = true;
+    batch->done.notify_all();
+}
+
+InferenceWorker::InferenceWorker(QObject* parent)
+    : QObject(parent) {
+    m_frameWidth = 0;
+    m_frameHeight = 0;
+    m_inputHeight = MODEL_INPUT_SIZE;
+    m_inputWidth = MODEL_INPUT_SIZE;
+    m_numThreads = cv::getNumThreads();
+    m_precision = get_int8Model_flag() ? ModelPrecision::INT8 : ModelPrecision::FP32;
+    m_microBatchMsPerTile.assign(NUM_MICRO_BATCH_CANDIDATES, 0.0);
+    m_nmsConfig.scoreThreshold = CONFIDENCE_THRESHOLD;
+    m_nmsConfig.iouThreshold = OVERLAP_THRESHOLD;
     readClassNames();
 }
 
@@ -16,14 +42,39 @@ InferenceWorker::~InferenceWorker() {
     clearInput();
 }
 
+std::string InferenceWorker::modelPathFor(ModelPrecision precision) {
+    return precision == ModelPrecision::INT8 ? "deps/models/yolo12n_DynamicAxis_int8_qdq.onnx"
+                                             : "deps/models/yolo12n_DynamicAxis.onnx";
+}
+
 void InferenceWorker::initializeONNXRuntime() {
+    std::string modelPath = modelPathFor(m_precision);
+    if (m_precision == ModelPrecision::INT8 && !std::filesystem::exists(modelPath)) {
+        LOG_WARNING("INT8 model not found: " << modelPath << " (run tools/quantize_int8.py), falling back to FP32");
+        m_precision = ModelPrecision::FP32;
+        modelPath = modelPathFor(m_precision);
+    }
+    if (!std::filesystem::exists(modelPath)) {
+        LOG_CRITICAL("Model file does not exist: " << modelPath);
+        throw std::runtime_error("Model file not found");
+    }
+
     try {
-        // Create ONNX Runtime environment
-        m_env = std::make_unique<Ort::Env>(ORT_LOGGING_LEVEL_WARNING, "YOLOv11");
+        // Create ONNX Runtime environment, once: sessions of a reload must not outlive it
+        if (!m_env)
+            m_env = std::make_unique<Ort::Env>(ORT_LOGGING_LEVEL_WARNING, "YOLOv11");
         
         // Create session options
         Ort::SessionOptions sessionOptions;
-        sessionOptions.SetIntraOpNumThreads(std::thread::hardware_concurrency());
+        const RoleThreads threads = threadsForRole(m_threadRole, m_threadRoleIndex);
+        sessionOptions.SetIntraOpNumThreads(threads.intraOpThreads);
+        sessionOptions.SetInterOpNumThreads(threads.interOpThreads);
+        sessionOptions.SetExecutionMode(threads.interOpThreads > 1 ? ExecutionMode::ORT_PARALLEL : ExecutionMode::ORT_SEQUENTIAL);
+        sessionOptions.AddConfigEntry(kOrtSessionOptionsConfigAllowIntraOpSpinning, threads.allowSpinning ? "1" : "0");
+        sessionOptions.AddConfigEntry(kOrtSessionOptionsConfigAllowInterOpSpinning, threads.allowSpinning ? "1" : "0");
+        const std::string affinities = intraOpAffinities(threads);
+        if (!affinities.empty())
+            sessionOptions.AddConfigEntry(kOrtSessionOptionsConfigIntraOpThreadAffinities, affinities.c_str());
         sessionOptions.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_ALL);
         
         // Enable CUDA if available (optional - remove if CPU only)
@@ -31,25 +82,41 @@ void InferenceWorker::initializeONNXRuntime() {
         // sessionOptions.AppendExecutionProvider_CUDA(cudaOptions);
         
         // Create session
-        m_session = std::make_unique<Ort::Session>(*m_env, L"deps/models/yolo12n_DynamicAxis.onnx", sessionOptions);
+        // QDQ models keep float input/output, ORT fuses the Q/DQ pairs into int8 kernels at load.
+        // Built next to the current session, which stays in use if anything below throws.
+        // the file is read once, its hash names the optimized-model cache and keys the detection cache
+        uint64_t modelHash = 0;
+        const std::string cachePath = modelFileHash(modelPath, modelHash) ? optimizedModelCachePath(modelPath, modelHash) : std::string();
+        std::unique_ptr<MappedFile> mapping;
+        std::unique_ptr<Ort::Session> session = createSession(modelPath, sessionOptions, cachePath, mapping);
+        LOG_INFO("Loaded " << (m_precision == ModelPrecision::INT8 ? "INT8" : "FP32") << " model " << modelPath);
         
         // Get input/output info
-        auto inputNamePtr = m_session->GetInputNameAllocated(0, m_allocator);
-        auto outputNamePtr = m_session->GetOutputNameAllocated(0, m_allocator);
-        m_inputName = std::string(inputNamePtr.get());
-        m_outputName = std::string(outputNamePtr.get());
+        auto inputNamePtr = session->GetInputNameAllocated(0, m_allocator);
+        auto outputNamePtr = session->GetOutputNameAllocated(0, m_allocator);
         
         // Get input shape
-        auto inputTypeInfo = m_session->GetInputTypeInfo(0);
+        auto inputTypeInfo = session->GetInputTypeInfo(0);
         auto inputTensorInfo = inputTypeInfo.GetTensorTypeAndShapeInfo();
-        m_inputShape = inputTensorInfo.GetShape();
+        std::vector<int64_t> inputShape = inputTensorInfo.GetShape();
+
+        // swap in: whatever refers to the old session goes first, the session before the mapping it reads from
+        m_microBatches.clear();
+        m_microBatchTotal = 0;
+        m_batchBindings.clear();
+        m_session = std::move(session);
+        m_modelMapping = std::move(mapping);
+        m_inputName = std::string(inputNamePtr.get());
+        m_outputName = std::string(outputNamePtr.get());
+        m_inputShape = std::move(inputShape);
+        m_modelHash = modelHash;
         
         // Set input dimensions (assuming NCHW format: [batch, channels, height, width])
 		// batch, height and width are -1 for models that support dynamic batching
-        m_inputHeight = 640; //m_inputShape[2];
-        m_inputWidth = 640; //m_inputShape[3];
+        m_inputHeight = MODEL_INPUT_SIZE; //m_inputShape[2];
+        m_inputWidth = MODEL_INPUT_SIZE; //m_inputShape[3];
         
-        LOG_INFO("ONNX Runtime initialized successfully with CPU and " << std::thread::hardware_concurrency() << "threads");
+        LOG_INFO("ONNX Runtime initialized successfully with CPU and " << threads.intraOpThreads << " threads");
         LOG_INFO("Input shape: " << m_inputShape[0] << "x" << m_inputShape[1] << "x" << m_inputShape[2] << "x" << m_inputShape[3]);
         
     } catch (const Ort::Exception& e) {
@@ -58,99 +125,324 @@ void InferenceWorker::initializeONNXRuntime() {
     }
 }
 
-std::vector<cv::Mat> InferenceWorker::splitImageIntoQuadrants(const cv::Mat& image) {
-    std::vector<cv::Mat> quadrants;
+std::unique_ptr<Ort::Session> InferenceWorker::createSession(const std::string& modelPath, const Ort::SessionOptions& options,
+    const std::string& cachePath, std::unique_ptr<MappedFile>& mapping) {
+    auto start = std::chrono::high_resolution_clock::now();
+    auto elapsedMs = [&start] {
+        return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+    };
+
+    std::error_code ec;
+
+    if (!cachePath.empty() && std::filesystem::exists(cachePath, ec)) {
+        try {
+            // already optimized: no parsing of the ONNX graph and no optimizer passes, initializers
+            // are used in place from the mapping
+            mapping = std::make_unique<MappedFile>(cachePath);
+            Ort::SessionOptions cachedOptions = options.Clone();
+            cachedOptions.AddConfigEntry(kOrtSessionOptionsConfigLoadModelFormat, "ORT");
+            cachedOptions.AddConfigEntry(kOrtSessionOptionsConfigUseORTModelBytesDirectly, "1");
+            cachedOptions.AddConfigEntry(kOrtSessionOptionsConfigUseORTModelBytesForInitializers, "1");
+            cachedOptions.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_DISABLE_ALL);
+            auto session = std::make_unique<Ort::Session>(*m_env, mapping->data(), mapping->size(), cachedOptions);
+            LOG_INFO("Session created from optimized model cache " << cachePath << " in " << elapsedMs() << " ms");
+            return session;
+        } catch (const std::exception& e) {
+            LOG_WARNING("Optimized model cache " << cachePath << " is unusable (" << e.what() << "), rebuilding it");
+            mapping.reset();
+            std::filesystem::remove(cachePath, ec);
+            start = std::chrono::high_resolution_clock::now();
+        }
+    }
+
+    Ort::SessionOptions sessionOptions = options.Clone();
+    std::string tempPath;
+    if (!cachePath.empty()) {
+        // written under a per-thread name and renamed once complete, a crash or a second worker
+        // loading the same model never leaves a half-written cache behind
+        std::filesystem::create_directories(std::filesystem::path(cachePath).parent_path(), ec);
+        tempPath = cachePath + ".tmp" + std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id()));
+        sessionOptions.SetOptimizedModelFilePath(std::filesystem::path(tempPath).c_str());
+        sessionOptions.AddConfigEntry(kOrtSessionOptionsConfigSaveModelFormat, "ORT");
+    }
+
+    auto session = std::make_unique<Ort::Session>(*m_env, std::filesystem::path(modelPath).c_str(), sessionOptions);
+    const double ms = elapsedMs();
+
+    if (!tempPath.empty()) {
+        std::filesystem::rename(tempPath, cachePath, ec);
+        if (ec) {
+            LOG_WARNING("Could not store optimized model cache " << cachePath << ": " << ec.message());
+            std::filesystem::remove(tempPath, ec);
+        }
+        else {
+            LOG_INFO("Optimized model cached to " << cachePath);
+        }
+    }
+    LOG_INFO("Session created from " << modelPath << " (full graph optimization) in " << ms << " ms");
+    return session;
+}
+
+void InferenceWorker::applyThreadRole() {
+    const RoleThreads threads = threadsForRole(m_threadRole, m_threadRoleIndex);
+    pinCurrentThread(threads);
+
+    // the OpenCV pool is process-wide, only the macro service sizes it
+    if (threads.opencvThreads > 0) cv::setNumThreads(threads.opencvThreads);
+    m_numThreads = cv::getNumThreads();
+
+    LOG_INFO("Inference threads: " << threads.intraOpThreads << " intra-op, " << threads.interOpThreads << " inter-op, spinning "
+        << (threads.allowSpinning ? "on" : "off") << (threads.coreCount > 0 ? ", pinned to cores " : ", not pinned")
+        << (threads.coreCount > 0 ? std::to_string(threads.firstCore) + "-" + std::to_string(threads.firstCore + threads.coreCount - 1) : std::string())
+        << "; tile preprocess/decode on " << m_numThreads << " threads");
+}
+
+bool InferenceWorker::reloadSession() {
+    // the current session keeps serving until the new one is built
+    try {
+        initializeONNXRuntime();
+    } catch (const std::exception& e) {
+        LOG_CRITICAL("Session reload failed, keeping the current session: " << e.what());
+        return false;
+    }
+    applyThreadRole();
+    return true;
+}
+
+void InferenceWorker::initialize() {
+    // runs on the inference thread, so the UI stays responsive while the model loads
+    // per-tile work is spread over the cores not needed by the capture and UI threads
+    applyThreadRole();
+
+    try {
+        START_TIMER(sessionCreate);
+        initializeONNXRuntime();
+        END_TIMER(sessionCreate);
+
+        START_TIMER(warmUp);
+        warmUp();
+        END_TIMER(warmUp);
+    } catch (const std::exception& e) {
+        LOG_CRITICAL("Inference service failed to start: " << e.what());
+        m_session.reset();
+        emit serviceReady(false);
+        return;
+    }
+
+    LOG_INFO("Inference service ready");
+    emit serviceReady(true);
+}
+
+void InferenceWorker::warmUp() {
+    // one dummy batch the size of a default tiling, so the first real prediction doesn't pay for
+    // ORT's lazy allocations and kernel setup
+    const int batchSize = m_tileConfig.cols * m_tileConfig.rows;
+    std::vector<float> dummyInput(static_cast<size_t>(batchSize) * 3 * m_inputHeight * m_inputWidth, 0.0f);
+    std::vector<int64_t> inputShape = { batchSize, 3, m_inputHeight, m_inputWidth };
+    Ort::Value inputTensor = Ort::Value::CreateTensor<float>(
+        m_memoryInfo, dummyInput.data(), dummyInput.size(), inputShape.data(), inputShape.size());
+
+    const char* inputNames[] = { m_inputName.c_str() };
+    const char* outputNames[] = { m_outputName.c_str() };
+    std::vector<Ort::Value> outputTensors =
+        m_session->Run(Ort::RunOptions{ nullptr }, inputNames, &inputTensor, 1, outputNames, 1);
+
+    // output is [batch, 4 + classes, predictions], the bound output buffer is sized from it
+    std::vector<int64_t> outputShape = outputTensors[0].GetTensorTypeAndShapeInfo().GetShape();
+    m_outputChannels = outputShape[1];
+    m_numPredictions = outputShape[2];
+    LOG_INFO("Output shape: " << outputShape[0] << "x" << m_outputChannels << "x" << m_numPredictions);
 
-    if (TILE_FACTOR == 2){
-    int halfWidth = image.cols / 2;
-    int halfHeight = image.rows / 2;
+    // bind the preallocated buffers and run once more so the bound path is warm too
+    m_session->Run(Ort::RunOptions{ nullptr }, prepareBindings(batchSize));
+}
 
-    // Top-left quadrant
-    cv::Rect topLeft(0, 0, halfWidth, halfHeight);
-    quadrants.push_back(image(topLeft));
+Ort::IoBinding& InferenceWorker::prepareBindings(int batchSize) {
+    if (batchSize <= static_cast<int>(m_batchBindings.size()))
+        return m_batchBindings[batchSize - 1].binding;
 
-    // Top-right quadrant
-    cv::Rect topRight(halfWidth, 0, halfWidth, halfHeight);
-    quadrants.push_back(image(topRight));
+    // every batch the current grid can produce gets its tensors and binding now, in one go
+    const int maxBatch = std::max(batchSize, static_cast<int>(m_tileGrid.tiles.size()));
+    const size_t inputStride = static_cast<size_t>(3) * m_inputHeight * m_inputWidth;
+    const size_t outputStride = static_cast<size_t>(m_outputChannels) * m_numPredictions;
 
-    // Bottom-left quadrant
-    cv::Rect bottomLeft(0, halfHeight, halfWidth, halfHeight);
-    quadrants.push_back(image(bottomLeft));
+    // buffers only grow, a smaller batch uses the front of them. The tensors point into them,
+    // so all bindings are made again whenever this runs.
+    m_batchBindings.clear();
+    if (m_inputBuffer.size() < maxBatch * inputStride) m_inputBuffer.resize(maxBatch * inputStride);
+    if (m_outputBuffer.size() < maxBatch * outputStride) m_outputBuffer.resize(maxBatch * outputStride);
 
-    // Bottom-right quadrant
-    cv::Rect bottomRight(halfWidth, halfHeight, halfWidth, halfHeight);
-    quadrants.push_back(image(bottomRight));
+    m_batchBindings.resize(maxBatch);
+    for (int size = 1; size <= maxBatch; ++size) {
+        BatchBinding& bound = m_batchBindings[size - 1];
+        const int64_t inputShape[] = { size, 3, m_inputHeight, m_inputWidth };
+        const int64_t outputShape[] = { size, m_outputChannels, m_numPredictions };
+        bound.input = Ort::Value::CreateTensor<float>(m_memoryInfo, m_inputBuffer.data(), size * inputStride, inputShape, 4);
+        bound.output = Ort::Value::CreateTensor<float>(m_memoryInfo, m_outputBuffer.data(), size * outputStride, outputShape, 3);
+        bound.binding = Ort::IoBinding(*m_session);
+        bound.binding.BindInput(m_inputName.c_str(), bound.input);
+        bound.binding.BindOutput(m_outputName.c_str(), bound.output);
+    }
 
-	return quadrants;
+    LOG_INFO("IO bound for batches 1-" << maxBatch << " (" << maxBatch * (inputStride + outputStride) * sizeof(float) / (1024 * 1024) << " MB)");
+    return m_batchBindings[batchSize - 1].binding;
 }
 
+void InferenceWorker::applyModelInputSize() {
+    const int size = m_tileConfig.nativeResolution ? nativeTileSide(m_tileConfig) : MODEL_INPUT_SIZE;
+    if (size == m_inputWidth && size == m_inputHeight) return;
+
+    // the model has dynamic H/W: one anchor per cell of the stride 8, 16 and 32 heads
+    m_numPredictions = 0;
+    for (int stride : { 8, 16, 32 })
+        m_numPredictions += static_cast<int64_t>(size / stride) * (size / stride);
+    m_inputWidth = size;
+    m_inputHeight = size;
+
+    // bindings and micro-batch slices have the old shapes, and the tuned count was timed on them
+    m_batchBindings.clear();
+    m_microBatchTotal = 0;
+    m_tuningTrial = 0;
+    m_microBatchCount = MICRO_BATCH_CANDIDATES[0];
+
+    LOG_INFO("Model input set to " << size << "x" << size << " (" << m_numPredictions << " predictions per tile)");
+}
+
+const std::vector<cv::Mat>& InferenceWorker::splitImageIntoTiles(const cv::Mat& image) {
+    // reuses the tile and grid storage from the previous frame
+    m_tiles.clear();
+    m_batchTileIds.clear();
+
+    if (get_tileDumpDebug_flag()) {
+        std::filesystem::create_directories("tile_dump");
+    }
+
+    buildTileGrid(image.size(), m_tileConfig, m_tileGrid);
+    m_tiles.reserve(m_tileGrid.tiles.size());
+    if (get_benchDebug_flag())
+        LOG_INFO("Tiling " << m_tileGrid.cols << "x" << m_tileGrid.rows << " tiles of " << m_tileGrid.tileWidth << "x"
+        << m_tileGrid.tileHeight << " (overlap " << m_tileConfig.overlap << ")");
+
+    for (size_t t = 0; t < m_tileGrid.tiles.size(); ++t) {
+        m_tiles.push_back(image(m_tileGrid.tiles[t]));
+        m_batchTileIds.push_back(static_cast<int>(t));
+
+        // encoded off the inference path from the tile view, copied only when boxes get drawn into this frame later
+        AsyncImageWriter& writer = AsyncImageWriter::instance();
+        if (get_tileDumpDebug_flag() && writer.hasRoom()) {
+            int row = static_cast<int>(t) / m_tileGrid.cols;
+            int col = static_cast<int>(t) % m_tileGrid.cols;
+            std::string tileName = "tile_dump/tile_" + std::to_string(row) + "_" + std::to_string(col) + ".jpg";
+            writer.enqueue(tileName, m_drawResults ? m_tiles.back().clone() : m_tiles.back());
+        }
+    }
     
-	// ensure that the image is divisible by TILE_FACTOR
-	int tileWidth = image.cols / TILE_FACTOR;
-	int tileHeight = image.rows / TILE_FACTOR;
-
-    for (int i = 0; i < TILE_FACTOR; ++i) {
-        for (int j = 0; j < TILE_FACTOR; ++j) {
-            int x = j * tileWidth;
-            int y = i * tileHeight;
-            cv::Rect tileRect(x, y, tileWidth, tileHeight);
-            if (x + tileWidth <= image.cols && y + tileHeight <= image.rows) {
-                quadrants.push_back(image(tileRect));
-				cv::String tileName = "tile_" + std::to_string(i) + "_" + std::to_string(j) + ".jpg";
-                cv::imwrite(tileName, image(tileRect));
+    return m_tiles;
+}
+
+const std::vector<cv::Mat>& InferenceWorker::dropEmptyTiles() {
+    // tests are independent, each tile only writes its own flag
+    m_tileOccupied.assign(m_tiles.size(), 1);
+    cv::parallel_for_(cv::Range(0, static_cast<int>(m_tiles.size())), [&](const cv::Range& range) {
+        for (int i = range.start; i < range.end; ++i)
+            m_tileOccupied[i] = tileHasContent(m_tiles[i], m_tileContentConfig) ? 1 : 0;
+    }, static_cast<double>(m_tiles.size()));
+
+    const size_t total = m_tiles.size();
+    const size_t occupied = compactTiles();
+    if (get_benchDebug_flag())
+        LOG_INFO("Occupied tiles: " << occupied << "/" << total);
+    return m_tiles;
+}
+
+const std::vector<cv::Mat>& InferenceWorker::dropTilesWithoutCandidates(const cv::Mat& image) {
+    // the whole frame at the resized-tile input size through its own small buffers, batch 1
+    const int side = MODEL_INPUT_SIZE;
+    int64_t predictions = 0;
+    for (int stride : { 8, 16, 32 })
+        predictions += static_cast<int64_t>(side / stride) * (side / stride);
+    m_coarseInput.resize(static_cast<size_t>(3) * side * side);
+    m_coarseOutput.resize(static_cast<size_t>(m_outputChannels) * predictions);
+    preprocessTile(image, m_coarseInput.data(), side, side);
+
+    const int64_t inputShape[] = { 1, 3, side, side };
+    const int64_t outputShape[] = { 1, m_outputChannels, predictions };
+    Ort::Value input = Ort::Value::CreateTensor<float>(m_memoryInfo, m_coarseInput.data(), m_coarseInput.size(), inputShape, 4);
+    Ort::Value output = Ort::Value::CreateTensor<float>(m_memoryInfo, m_coarseOutput.data(), m_coarseOutput.size(), outputShape, 3);
+    const char* inputNames[] = { m_inputName.c_str() };
+    const char* outputNames[] = { m_outputName.c_str() };
+    m_session->Run(Ort::RunOptions{ nullptr }, inputNames, &input, 1, outputNames, &output, 1);
+
+    decodePredictions(m_coarseOutput.data(), static_cast<int>(m_outputChannels), static_cast<int>(predictions),
+        m_tileConfig.cascadeThreshold, m_coarseCandidates);
+
+    // candidate boxes in frame pixels, grown so a worm the coarse pass saw cut short still lands in its tiles
+    const float scaleX = static_cast<float>(image.cols) / side;
+    const float scaleY = static_cast<float>(image.rows) / side;
+    const int margin = std::max(m_tileConfig.cascadeMargin, 0);
+    m_coarseRegions.clear();
+    for (int k = 0; k < m_coarseCandidates.count; ++k) {
+        cv::Rect box = createBox(m_coarseCandidates.cx[k], m_coarseCandidates.cy[k], m_coarseCandidates.w[k],
+            m_coarseCandidates.h[k], scaleX, scaleY);
+        m_coarseRegions.push_back(cv::Rect(box.x - margin, box.y - margin, box.width + 2 * margin, box.height + 2 * margin));
+    }
+
+    m_tileOccupied.assign(m_tiles.size(), 0);
+    for (size_t i = 0; i < m_tiles.size(); ++i) {
+        const cv::Rect& tile = m_tileGrid.tiles[m_batchTileIds[i]];
+        for (const cv::Rect& region : m_coarseRegions) {
+            if ((tile & region).area() > 0) {
+                m_tileOccupied[i] = 1;
+                break;
             }
         }
-	}
-    
-    return quadrants;
+    }
+
+    const size_t total = m_tiles.size();
+    const size_t kept = compactTiles();
+    if (get_benchDebug_flag())
+        LOG_INFO("Coarse pass: " << m_coarseRegions.size() << " candidate regions, tiles kept " << kept << "/" << total);
+    return m_tiles;
+}
+
+size_t InferenceWorker::compactTiles() {
+    // compact in place, keeping grid order so batch entry b still maps to m_batchTileIds[b]
+    size_t kept = 0;
+    for (size_t i = 0; i < m_tiles.size(); ++i) {
+        if (!m_tileOccupied[i]) continue;
+        if (kept != i) {
+            m_tiles[kept] = m_tiles[i];
+            m_batchTileIds[kept] = m_batchTileIds[i];
+        }
+        ++kept;
+    }
+    m_tiles.resize(kept);
+    m_batchTileIds.resize(kept);
+    return kept;
 }
 
 std::vector<float> InferenceWorker::preprocessImage(const cv::Mat& image) {
-    cv::Mat resized;
-    cv::resize(image, resized, cv::Size(m_inputWidth, m_inputHeight));
-    
-    // Normalize and convert to float
-    cv::Mat normalized;
-    resized.convertTo(normalized, CV_32F, 1.0 / 255.0);
-    
-    // Convert HWC to CHW format
     std::vector<float> input(m_inputWidth * m_inputHeight * 3);
-    std::vector<cv::Mat> channels(3);
-    cv::split(normalized, channels);
-    
-    for (int c = 0; c < 3; ++c) {
-        std::memcpy(input.data() + c * m_inputWidth * m_inputHeight, 
-                   channels[c].data, m_inputWidth * m_inputHeight * sizeof(float));
-    }
-    
+    preprocessTile(image, input.data(), m_inputWidth, m_inputHeight);
     return input;
 }
 
-std::vector<float> InferenceWorker::preprocessBatchedImages(const std::vector<cv::Mat>& images) {
-    int batchSize = images.size();
-    int inputSize = m_inputWidth * m_inputHeight * 3;
-    std::vector<float> batchedInput(batchSize * inputSize);
+void InferenceWorker::preprocessBatchedImages(const std::vector<cv::Mat>& images, float* batchedInput, int first, int count) {
+    if (count < 0) count = static_cast<int>(images.size()) - first;
+    size_t inputSize = m_inputWidth * m_inputHeight * 3;
     
-    for (int i = 0; i < batchSize; ++i) {
-        cv::Mat resized;
-        cv::resize(images[i], resized, cv::Size(m_inputWidth, m_inputHeight));
-
-        // Normalize and convert to float
-        cv::Mat normalized;
-        resized.convertTo(normalized, CV_32F, 1.0 / 255.0);
+    const bool native = m_tileConfig.nativeResolution;
 
-        // Convert HWC to CHW format
-        std::vector<float> input(m_inputWidth * m_inputHeight * 3);
-        std::vector<cv::Mat> channels(3);
-        cv::split(normalized, channels);
-
-        for (int c = 0; c < 3; ++c) {
-            std::memcpy(batchedInput.data() + c * m_inputWidth * m_inputHeight + i * inputSize,
-                       channels[c].data, m_inputWidth * m_inputHeight * sizeof(float));
-		}
-    }
-    
-    return batchedInput;
+    // resize (or pad, for native tiles), normalize and HWC -> CHW in one pass, straight into each
+    // tile's slice of the batch. Tiles write disjoint slices, so they can be processed in parallel
+    cv::parallel_for_(cv::Range(first, first + count), [&](const cv::Range& range) {
+        for (int i = range.start; i < range.end; ++i) {
+            if (native)
+                packTile(images[i], batchedInput + i * inputSize, m_inputWidth, m_inputHeight);
+            else
+                preprocessTile(images[i], batchedInput + i * inputSize, m_inputWidth, m_inputHeight);
+        }
+    }, count);
 }
 
 cv::Rect InferenceWorker::createBox(float cx, float cy, float w, float h, float scale_x, float scale_y) {
@@ -169,71 +461,6 @@ cv::Rect InferenceWorker::createBox(float cx, float cy, float w, float h, float
     return cv::Rect(cv::Point(x1, y1), cv::Point(x2, y2));
 }
 
-cv::Rect InferenceWorker::createBoxForQuadrant(float cx, float cy, float w, float h, float scale_x, float scale_y, int quadrant, int quadWidth, int quadHeight) {
-    // Convert from center coordinates to top-left coordinates
-    float x1 = (cx - w / 2) * scale_x;
-    float y1 = (cy - h / 2) * scale_y;
-    float x2 = (cx + w / 2) * scale_x;
-    float y2 = (cy + h / 2) * scale_y;
-    
-    // Clamp to quadrant bounds
-    x1 = std::max(0.0f, std::min(x1, static_cast<float>(quadWidth)));
-    y1 = std::max(0.0f, std::min(y1, static_cast<float>(quadHeight)));
-    x2 = std::max(0.0f, std::min(x2, static_cast<float>(quadWidth)));
-    y2 = std::max(0.0f, std::min(y2, static_cast<float>(quadHeight)));
-
-    if (TILE_FACTOR == 2) {
-        // Adjust coordinates to original image based on quadrant
-        int halfWidth = m_inputFrame.cols / 2;
-        int halfHeight = m_inputFrame.rows / 2;
-        switch (quadrant) {
-            case 1: // Top-left
-                // No adjustment needed
-                break;
-            case 2: // Top-right
-                x1 += halfWidth;
-                x2 += halfWidth;
-                break;
-            case 3: // Bottom-left
-                y1 += halfHeight;
-                y2 += halfHeight;
-                break;
-            case 4: // Bottom-right
-                x1 += halfWidth;
-                x2 += halfWidth;
-                y1 += halfHeight;
-                y2 += halfHeight;
-                break;
-        }
-        return cv::Rect(cv::Point(x1, y1), cv::Point(x2, y2));
-	}
-    
-    if (quadrant > 0 && quadrant <= 4) {
-		x1 += (quadrant - 1) * quadWidth;
-		x2 += (quadrant - 1) * quadWidth;
-    }
-    else if (quadrant > 4 && quadrant <= 8) {
-		x1 += (quadrant - 4 - 1) * quadWidth;
-		x2 += (quadrant - 4 - 1) * quadWidth;
-		y1 += quadHeight;
-		y2 += quadHeight;
-    }
-    else if (quadrant > 8 && quadrant <= 12) {
-		x1 += (quadrant - 8 - 1) * quadWidth;
-		x2 += (quadrant - 8 - 1) * quadWidth;
-		y1 += 2 * quadHeight;
-		y2 += 2 * quadHeight;
-    }
-    else if (quadrant > 12 && quadrant <= 16) {
-		x1 += (quadrant - 12 - 1) * quadWidth;
-		x2 += (quadrant - 12 - 1) * quadWidth;
-		y1 += 3 * quadHeight;
-		y2 += 3 * quadHeight;
-    }
-
-    return cv::Rect(cv::Point(x1, y1), cv::Point(x2, y2));
-}
-
 std::vector<cv::Rect> InferenceWorker::drawBoxes(std::vector<cv::Rect>& boxes, std::vector<int>& classIds, 
                                    std::vector<float>& confidences, std::vector<int>& indices) {
 	std::vector<cv::Rect> centroids;
@@ -321,57 +548,208 @@ void InferenceWorker::runModel(cv::Mat& input) {
     }
 }
 
-std::vector<cv::Rect> InferenceWorker::runBatchedModel(cv::Mat& input) {
+void InferenceWorker::runBatchedModel(cv::Mat& input) {
+    m_lastDetections.clear();
+    m_lastDetectionsValid = false;
+    m_lastBatchSize = -1;
+    // stage timings only with benchDebug, detect() logs one summary line per prediction
+    const bool logStages = get_benchDebug_flag();
+
     try {
-        // Split image into quadrants
+        // Split image into tiles
         START_TIMER(split);
-        std::vector<cv::Mat> quadrants = splitImageIntoQuadrants(input);
-        END_TIMER(split);
-        
-        // Preprocess all quadrants
-        START_TIMER(preprocess);
-        std::vector<float> inputData = preprocessBatchedImages(quadrants);
-        END_TIMER(preprocess);
-        
-        // Create input tensor with batch size 4
-        std::vector<int64_t> inputShape = {TILE_FACTOR * TILE_FACTOR, 3, m_inputHeight, m_inputWidth};
-        Ort::Value inputTensor = Ort::Value::CreateTensor<float>(
-            m_memoryInfo, inputData.data(), inputData.size(), inputShape.data(), inputShape.size());
-        
-        // Run inference
-        const char* inputNames[] = { m_inputName.c_str() };
-        const char* outputNames[] = { m_outputName.c_str() };
+        const std::vector<cv::Mat>& tiles = splitImageIntoTiles(input);
+        END_TIMER_IF(logStages, split);
+
+        // background and empty agar tiles never reach ORT, inference scales with the occupied area
+        if (m_tileConfig.skipEmptyTiles) {
+            START_TIMER(contentCheck);
+            dropEmptyTiles();
+            END_TIMER_IF(logStages, contentCheck);
+        }
+
+        // cascade: a cheap whole-frame pass decides which of the remaining tiles are worth full resolution
+        if (m_tileConfig.cascade && !tiles.empty()) {
+            START_TIMER(coarsePass);
+            dropTilesWithoutCandidates(input);
+            END_TIMER_IF(logStages, coarsePass);
+        }
+
+        if (tiles.empty()) {
+            m_lastDetectionsValid = true;
+            m_lastBatchSize = 0;
+            return;
+        }
+
+        // one batch entry per occupied tile
+        const int batchSize = static_cast<int>(tiles.size());
+        if (logStages)
+            LOG_INFO("Inference over " << batchSize << " tiles in " << std::min(m_microBatchCount, batchSize) << " micro-batch(es)");
         
+        // preprocess, run and decode, overlapped across micro-batches once that has proven faster
         START_TIMER(inference);
-        std::vector<Ort::Value> outputTensors = m_session->Run(
-            Ort::RunOptions{nullptr}, inputNames, &inputTensor, 1, outputNames, 1);
-        END_TIMER(inference);
+        inferTiles(tiles);
+        END_TIMER_IF(logStages, inference);
+        recordMicroBatchTiming(std::chrono::duration<double, std::milli>(end_inference - start_inference).count() / batchSize);
         
-        // Process output
+        // merge, NMS and drawing
         START_TIMER(postprocess);
-        auto ret = processBatchedOutput(outputTensors[0], input);
-        END_TIMER(postprocess);
-
-		return ret;
+        processBatchedOutput(batchSize);
+        END_TIMER_IF(logStages, postprocess);
+        m_lastDetectionsValid = true;
+        m_lastBatchSize = batchSize;
         
     } catch (const Ort::Exception& e) {
         LOG_CRITICAL("ONNX Runtime inference failed: " << e.what());
     }
 }
 
-std::vector<cv::Rect> InferenceWorker::shortestPath(std::vector<cv::Rect>& centroids) {
-    if (centroids.empty()) {
-		LOG_INFO("No centroids found for shortest path calculation.");
-        return {};
+void InferenceWorker::inferTiles(const std::vector<cv::Mat>& tiles) {
+    const int batchSize = static_cast<int>(tiles.size());
+
+    // buffers are sized for the whole batch either way, micro-batches are slices of them
+    Ort::IoBinding& binding = prepareBindings(batchSize);
+    if (m_tileDetections.size() < tiles.size())
+        m_tileDetections.resize(tiles.size());
+
+    if (m_microBatchCount > 1 && batchSize > 1) {
+        runPipelined(tiles);
+        return;
+    }
+
+    preprocessBatchedImages(tiles, m_inputBuffer.data());
+    m_session->Run(Ort::RunOptions{ nullptr }, binding);
+    decodeBatchedOutput(m_outputBuffer.data(), 0, batchSize);
+}
+
+void InferenceWorker::runPipelined(const std::vector<cv::Mat>& tiles) {
+    prepareMicroBatches(static_cast<int>(tiles.size()), m_microBatchCount);
+    const int numBatches = static_cast<int>(m_microBatches.size());
+
+    // ORT runs micro-batch k on its pool while this thread preprocesses k + 1 and decodes k - 1.
+    // Slices of the IO buffers are disjoint, so the stages never touch the same memory.
+    int pending = -1;
+    try {
+        MicroBatch& head = *m_microBatches[0];
+        preprocessBatchedImages(tiles, m_inputBuffer.data(), head.first, head.count);
+        startMicroBatch(head);
+        pending = 0;
+
+        for (int k = 1; k <= numBatches; ++k) {
+            if (k < numBatches) {
+                const MicroBatch& next = *m_microBatches[k];
+                preprocessBatchedImages(tiles, m_inputBuffer.data(), next.first, next.count);
+            }
+
+            MicroBatch& done = *m_microBatches[k - 1];
+            pending = -1;
+            std::string error = waitMicroBatch(done);
+            if (!error.empty()) throw Ort::Exception(std::move(error), ORT_FAIL);
+
+            if (k < numBatches) {
+                startMicroBatch(*m_microBatches[k]);
+                pending = k;
+            }
+            decodeBatchedOutput(m_outputBuffer.data(), done.first, done.count);
+        }
+    } catch (...) {
+        // never leave ORT writing into buffers the next prediction is about to reuse
+        if (pending >= 0) waitMicroBatch(*m_microBatches[pending]);
+        throw;
     }
+}
+
+void InferenceWorker::prepareMicroBatches(int batchSize, int count) {
+    // cut once per (batch size, count), again only if prepareBindings had to grow the buffers
+    if (batchSize == m_microBatchTotal && count == m_microBatchCut &&
+        m_microInputBase == m_inputBuffer.data() && m_microOutputBase == m_outputBuffer.data()) return;
+
+    m_microBatches.clear();
+    const int sliceSize = (batchSize + count - 1) / count;
+    const size_t inputStride = static_cast<size_t>(3) * m_inputHeight * m_inputWidth;
+    const size_t outputStride = static_cast<size_t>(m_outputChannels) * m_numPredictions;
+
+    for (int first = 0; first < batchSize; first += sliceSize) {
+        auto batch = std::make_unique<MicroBatch>();
+        batch->first = first;
+        batch->count = std::min(sliceSize, batchSize - first);
+        batch->inputName = m_inputName.c_str();
+        batch->outputName = m_outputName.c_str();
+
+        const int64_t inputShape[] = { batch->count, 3, m_inputHeight, m_inputWidth };
+        const int64_t outputShape[] = { batch->count, m_outputChannels, m_numPredictions };
+        batch->input = Ort::Value::CreateTensor<float>(m_memoryInfo, m_inputBuffer.data() + first * inputStride,
+            batch->count * inputStride, inputShape, 4);
+        batch->output = Ort::Value::CreateTensor<float>(m_memoryInfo, m_outputBuffer.data() + first * outputStride,
+            batch->count * outputStride, outputShape, 3);
+        m_microBatches.push_back(std::move(batch));
+    }
+
+    m_microBatchTotal = batchSize;
+    m_microBatchCut = count;
+    m_microInputBase = m_inputBuffer.data();
+    m_microOutputBase = m_outputBuffer.data();
+}
+
+void InferenceWorker::startMicroBatch(MicroBatch& batch) {
+    {
+        std::lock_guard<std::mutex> lock(batch.mutex);
+        batch.finished = false;
+        batch.error.clear();
+    }
+
+    try {
+        m_session->RunAsync(m_runOptions, &batch.inputName, &batch.input, 1, &batch.outputName, &batch.output, 1,
+            onMicroBatchDone, &batch);
+    } catch (...) {
+        // nothing was queued, so nothing will ever signal this slice
+        std::lock_guard<std::mutex> lock(batch.mutex);
+        batch.finished = true;
+        throw;
+    }
+}
+
+std::string InferenceWorker::waitMicroBatch(MicroBatch& batch) {
+    std::unique_lock<std::mutex> lock(batch.mutex);
+    batch.done.wait(lock, [&batch] { return batch.finished; });
+    return batch.error;
+}
+
+void InferenceWorker::recordMicroBatchTiming(double msPerTile) {
+    const int totalTrials = NUM_MICRO_BATCH_CANDIDATES * TUNING_RUNS;
+    if (m_tuningTrial >= totalTrials) return;
+
+    // per tile, since empty-tile skipping changes the batch size from frame to frame
+    if (m_tuningTrial % TUNING_RUNS == TUNING_RUNS - 1)
+        m_microBatchMsPerTile[m_tuningTrial / TUNING_RUNS] = msPerTile;
+
+    if (++m_tuningTrial < totalTrials) {
+        m_microBatchCount = MICRO_BATCH_CANDIDATES[m_tuningTrial / TUNING_RUNS];
+        return;
+    }
+
+    int best = 0;
+    for (int i = 1; i < NUM_MICRO_BATCH_CANDIDATES; ++i) {
+        if (m_microBatchMsPerTile[i] < m_microBatchMsPerTile[best]) best = i;
+    }
+    m_microBatchCount = MICRO_BATCH_CANDIDATES[best];
+
+    for (int i = 0; i < NUM_MICRO_BATCH_CANDIDATES; ++i) {
+        LOG_INFO("Micro-batch tuning: " << MICRO_BATCH_CANDIDATES[i] << " micro-batch(es) " << m_microBatchMsPerTile[i] << " ms/tile");
+    }
+    LOG_INFO("Micro-batch tuning done, using " << m_microBatchCount << " micro-batch(es)");
+}
+
+void InferenceWorker::shortestPath(const std::vector<cv::Rect>& centroids, std::vector<cv::Rect>& path) {
+    path.clear();
+    if (centroids.empty()) return;
 
     const size_t n = centroids.size();
-    std::vector<cv::Rect> path;
-    std::vector<bool> used(n, false);
-    path.reserve(n);
+    std::vector<char>& used = m_pathUsed;
+    used.assign(n, 0);
 
     path.push_back(centroids[0]);
-    used[0] = true;
+    used[0] = 1;
 
     for (size_t count = 1; count < n; ++count) {
         const cv::Rect& current = path.back();
@@ -393,10 +771,8 @@ std::vector<cv::Rect> InferenceWorker::shortestPath(std::vector<cv::Rect>& centr
         }
 
         path.push_back(centroids[nearest_idx]);
-        used[nearest_idx] = true;
+        used[nearest_idx] = 1;
     }
-
-    return path;
 }
 
 
@@ -405,177 +781,597 @@ void InferenceWorker::processOutput(Ort::Value& output, cv::Mat& originalImage)
     auto outputShape = output.GetTensorTypeAndShapeInfo().GetShape();
     float* outputData = output.GetTensorMutableData<float>();
 
-	// float array to vector
-    size_t output_size = 1;
-    for (auto dim : outputShape) {
-        output_size *= dim;
-    }
-    std::vector<float> outputVec(outputData, outputData + output_size);
-    
-    // YOLOv11 output format: [batch, predictions, (x, y, w, h, class_scores...)]
+    // YOLOv11 output format: [batch, (x, y, w, h, class_scores...), predictions], decoded in place
     int numPredictions = outputShape[2];
     int predictionSize = outputShape[1];
     
-    std::vector<float> confidences;
-    std::vector<cv::Rect> boxes;
-    std::vector<int> classIds;
+    DetectionCandidates candidates;
+    decodePredictions(outputData, predictionSize, numPredictions, m_nmsConfig.scoreThreshold, candidates);
     
     // Calculate scale factors
     float scaleX = static_cast<float>(originalImage.cols) / m_inputWidth;
     float scaleY = static_cast<float>(originalImage.rows) / m_inputHeight;
     
-    for (int i = 0; i < numPredictions; ++i) {
-        // For output shape [1, 6, 8400], data is organized as:
-        // output[0*8400 + i] = x_center
-        // output[1*8400 + i] = y_center  
-        // output[2*8400 + i] = width
-        // output[3*8400 + i] = height
-        // output[4*8400 + i] = confidence1
-        // output[5*8400 + i] = confidence2
-
-        float* prediction = outputData + i * numPredictions;
-        
-        // Extract coordinates
-        float cx = outputVec[0 * numPredictions + i];
-        float cy = outputVec[1 * numPredictions + i];
-        float w = outputVec[2 * numPredictions + i];
-        float h = outputVec[3 * numPredictions + i];
-        
-        // Find max class score
-        float maxClassScore = 0.0f;
-        int maxClassId = 0;
-        
-        for (int j = 4; j < predictionSize; ++j) {
-            if (outputVec[j * numPredictions + i] > maxClassScore) {
-                maxClassScore = outputVec[j * numPredictions + i];
-                maxClassId = j - 4;
-            }
-        }
-        
-        // Filter by confidence threshold
-        if (maxClassScore > CONFIDENCE_THRESHOLD) {
-            confidences.push_back(maxClassScore);
-            classIds.push_back(maxClassId);
-            
-            cv::Rect box = createBox(cx, cy, w, h, scaleX, scaleY);
-            boxes.push_back(box);
-        }
+    std::vector<float> confidences(candidates.scores.begin(), candidates.scores.begin() + candidates.count);
+    std::vector<int> classIds(candidates.classIds.begin(), candidates.classIds.begin() + candidates.count);
+    std::vector<cv::Rect> boxes;
+    boxes.reserve(candidates.count);
+    for (int k = 0; k < candidates.count; ++k) {
+        boxes.push_back(createBox(candidates.cx[k], candidates.cy[k], candidates.w[k], candidates.h[k], scaleX, scaleY));
     }
     
     // Apply Non-Maximum Suppression
     std::vector<int> indices;
-    cv::dnn::NMSBoxes(boxes, confidences, CONFIDENCE_THRESHOLD, OVERLAP_THRESHOLD, indices);
+    nonMaxSuppression(boxes, confidences, classIds, m_nmsConfig, indices);
     
     // Draw results
     drawBoxes(boxes, classIds, confidences, indices);
 	LOG_INFO("Valid detections found - " << indices.size());
 }
 
-std::vector<cv::Rect> InferenceWorker::processBatchedOutput(Ort::Value& output, cv::Mat& originalImage) {
-    // Get output tensor info
-    auto outputShape = output.GetTensorTypeAndShapeInfo().GetShape();
-    float* outputData = output.GetTensorMutableData<float>();
+void InferenceWorker::decodeTile(const float* outputData, int batchIndex, float scaleX, float scaleY, TileDetections& detections) {
+    const float* tileOutput = outputData + static_cast<size_t>(batchIndex) * m_outputChannels * m_numPredictions;
+    DetectionCandidates& candidates = detections.candidates;
+    decodePredictions(tileOutput, m_outputChannels, m_numPredictions, MIN_CONFIDENCE_THRESHOLD, candidates);
 
-    // YOLOv11 output format: [batch, predictions, (x, y, w, h, class_scores...)]
-    int batchSize = outputShape[0];
-    int predictionSize = outputShape[1];
-    int numPredictions = outputShape[2];
-    
-    std::vector<float> allConfidences;
-    std::vector<cv::Rect> allBoxes;
-    std::vector<int> allClassIds;
-    std::vector<cv::Point> allCentroids;
+    // only the survivors get mapped back to frame pixels
+    const cv::Rect& tileRect = m_tileGrid.tiles[m_batchTileIds[batchIndex]];
+    detections.boxes.clear();
+    for (int k = 0; k < candidates.count; ++k) {
+        detections.boxes.push_back(remapTileBox(candidates.cx[k], candidates.cy[k], candidates.w[k], candidates.h[k],
+            scaleX, scaleY, tileRect));
+    }
+}
 
-    float scaleX, scaleY;
-	int tileWidth = 0, tileHeight = 0;
-    
-    // Calculate scale factors for each quadrant
-    if (TILE_FACTOR == 2) {
-        // For 2x2 tiling, calculate half dimensions
-        tileWidth = originalImage.cols / 2;
-        tileHeight = originalImage.rows / 2;
-        scaleX = static_cast<float>(tileWidth) / m_inputWidth;
-        scaleY = static_cast<float>(tileHeight) / m_inputHeight;
+void InferenceWorker::decodeBatchedOutput(const float* outputData, int first, int count) {
+    // YOLOv11 output format: [batch, (x, y, w, h, class_scores...), predictions], read in place from the bound buffer
+    // all tiles share one size, so one scale maps model coordinates back to tile pixels
+    float scaleX = static_cast<float>(m_tileGrid.tileWidth) / m_inputWidth;
+    float scaleY = static_cast<float>(m_tileGrid.tileHeight) / m_inputHeight;
+
+    // decode every tile in parallel into its own buffers, cleared but kept between predictions
+    if (m_tileDetections.size() < static_cast<size_t>(first + count))
+        m_tileDetections.resize(first + count);
+    cv::parallel_for_(cv::Range(first, first + count), [&](const cv::Range& range) {
+        for (int b = range.start; b < range.end; ++b) {
+            decodeTile(outputData, b, scaleX, scaleY, m_tileDetections[b]);
+        }
+    }, count);
+}
+
+void InferenceWorker::processBatchedOutput(int batchSize) {
+    START_TIMER(mergeNms);
+    collectDetections(batchSize);
+    END_TIMER_IF(get_benchDebug_flag(), mergeNms);
+
+    if (m_keep.empty()) return;
+
+    for (int idx : m_keep) {
+        m_lastDetections.boxes.push_back(m_allBoxes[idx]);
+        m_lastDetections.classIds.push_back(m_allClassIds[idx]);
+        m_lastDetections.scores.push_back(m_allConfidences[idx]);
+    }
+    shortestPath(m_lastDetections.boxes, m_lastDetections.path);
+
+    if (m_drawResults)
+        drawDetections(m_lastDetections);
+}
+
+void InferenceWorker::drawDetections(DetectionResult& detections) {
+    std::vector<int> indices(detections.boxes.size());
+    for (size_t i = 0; i < indices.size(); ++i) indices[i] = static_cast<int>(i);
+    drawBoxes(detections.boxes, detections.classIds, detections.scores, indices);
+    drawPath(detections.path);
+}
+
+void InferenceWorker::saveResultImage() {
+    // drawn results are already in m_inputFrame, otherwise the boxes go into a copy here, off the UI thread
+    if (!m_drawResults) {
+        m_inputFrame = m_sourceFrame.clone();
+        drawDetections(m_lastDetections);
+    }
+    if (!AsyncImageWriter::instance().enqueue("output.jpg", m_inputFrame))
+        LOG_WARNING("Image writer queue is full, output.jpg not updated");
+}
+
+void InferenceWorker::drawPath(const std::vector<cv::Rect>& path) {
+    for (size_t i = 0; i + 1 < path.size(); ++i) {
+        cv::line(m_inputFrame,  (path[i].tl() + path[i].br()) * 0.5, (path[i + 1].tl() + path[i + 1].br()) * 0.5, cv::Scalar(255, 0, 0), 2);
 	}
-    else if (TILE_FACTOR == 4) {
-        // Calculate tile dimensions
-        tileWidth = originalImage.cols / TILE_FACTOR;
-        tileHeight = originalImage.rows / TILE_FACTOR;
-        scaleX = static_cast<float>(tileWidth) / m_inputWidth;
-        scaleY = static_cast<float>(tileHeight) / m_inputHeight;
+}
+
+uint64_t InferenceWorker::detectionSettingsHash() const {
+    // bump when a code change alters results for the same settings, old sidecars then stop matching
+    const uint32_t resultVersion = 1;
+    const float confidenceThreshold = MIN_CONFIDENCE_THRESHOLD;
+
+    uint64_t hash = hashBytes(0, &resultVersion, sizeof(resultVersion));
+    hash = hashBytes(hash, &m_modelHash, sizeof(m_modelHash));
+    hash = hashBytes(hash, &confidenceThreshold, sizeof(confidenceThreshold));
+    const float nms[] = { m_nmsConfig.scoreThreshold, m_nmsConfig.iouThreshold, m_nmsConfig.softSigma,
+                          m_nmsConfig.classAware ? 1.0f : 0.0f, m_nmsConfig.softNms ? 1.0f : 0.0f };
+    hash = hashBytes(hash, nms, sizeof(nms));
+    const float tiling[] = { static_cast<float>(m_tileConfig.cols), static_cast<float>(m_tileConfig.rows), m_tileConfig.overlap,
+                             m_tileConfig.skipEmptyTiles ? 1.0f : 0.0f, m_tileConfig.nativeResolution ? 1.0f : 0.0f,
+                             static_cast<float>(m_tileConfig.nativeTileSize), m_tileConfig.cascade ? 1.0f : 0.0f,
+                             m_tileConfig.cascadeThreshold, static_cast<float>(m_tileConfig.cascadeMargin) };
+    hash = hashBytes(hash, tiling, sizeof(tiling));
+    const float content[] = { static_cast<float>(m_tileContentConfig.downsample), static_cast<float>(m_tileContentConfig.darkThreshold),
+                              m_tileContentConfig.minForegroundFraction, static_cast<float>(m_tileContentConfig.edgeThreshold),
+                              static_cast<float>(m_tileContentConfig.minEdgePixels) };
+    return hashBytes(hash, content, sizeof(content));
+}
+
+void InferenceWorker::collectDetections(int batchSize) {
+    // merge in tile order so the NMS input does not depend on thread scheduling. Tiles hold everything
+    // above the decode floor, only candidates above the current cut take part.
+    const float threshold = m_nmsConfig.scoreThreshold;
+    std::vector<cv::Rect>& allBoxes = m_allBoxes;
+    std::vector<float>& allConfidences = m_allConfidences;
+    std::vector<int>& allClassIds = m_allClassIds;
+    std::vector<int>& allTileIds = m_allTileIds;
+    allBoxes.clear();
+    allConfidences.clear();
+    allClassIds.clear();
+    allTileIds.clear();
+    for (int b = 0; b < batchSize; ++b) {
+        const TileDetections& tile = m_tileDetections[b];
+        const DetectionCandidates& candidates = tile.candidates;
+        for (int k = 0; k < candidates.count; ++k) {
+            if (candidates.scores[k] <= threshold) continue;
+            allConfidences.push_back(candidates.scores[k]);
+            allBoxes.push_back(tile.boxes[k]);
+            allClassIds.push_back(candidates.classIds[k]);
+            allTileIds.push_back(m_batchTileIds[b]);
+        }
     }
+
+    // stitch detections that a tile seam cut in two, NMS can't match a clipped half against the whole box
+    mergeCrossTileDuplicates(m_tileGrid, allBoxes, allConfidences, allClassIds, allTileIds);
     
-    for (int b = 0; b < batchSize; ++b) {
-        // Calculate offset for this batch
-        int batchOffset = b * predictionSize * numPredictions;
-        
-        for (int i = 0; i < numPredictions; ++i) {
-            // Extract coordinates for this prediction in this batch
-            float cx = outputData[batchOffset + 0 * numPredictions + i];
-            float cy = outputData[batchOffset + 1 * numPredictions + i];
-            float w = outputData[batchOffset + 2 * numPredictions + i];
-            float h = outputData[batchOffset + 3 * numPredictions + i];
-            
-            // Find max class score
-            float maxClassScore = 0.0f;
-            int maxClassId = 0;
-            
-            for (int j = 4; j < predictionSize; ++j) {
-                float score = outputData[batchOffset + j * numPredictions + i];
-                if (score > maxClassScore) {
-                    maxClassScore = score;
-                    maxClassId = j - 4;
+    // Apply global class-aware NMS to remove overlapping detections between tiles
+    nonMaxSuppression(allBoxes, allConfidences, allClassIds, m_nmsConfig, m_keep);
+}
+
+void InferenceWorker::benchmarkParallelScaling() {
+    try {
+        const std::vector<cv::Mat>& tiles = splitImageIntoTiles(m_inputFrame);
+        if (tiles.empty()) return;
+
+        // one real run to fill the bound output buffer with something to decode
+        const int batchSize = static_cast<int>(tiles.size());
+        Ort::IoBinding& binding = prepareBindings(batchSize);
+        preprocessBatchedImages(tiles, m_inputBuffer.data());
+        m_session->Run(Ort::RunOptions{ nullptr }, binding);
+        benchmarkDecode(m_outputBuffer.data(), batchSize, m_outputChannels, m_numPredictions, CONFIDENCE_THRESHOLD);
+
+        const int iterations = 5;
+        for (int threads = 1; ; threads = std::min(threads * 2, m_numThreads)) {
+            cv::setNumThreads(threads);
+
+            auto startPre = std::chrono::high_resolution_clock::now();
+            for (int it = 0; it < iterations; ++it)
+                preprocessBatchedImages(tiles, m_inputBuffer.data());
+            auto endPre = std::chrono::high_resolution_clock::now();
+
+            auto startDecode = std::chrono::high_resolution_clock::now();
+            for (int it = 0; it < iterations; ++it)
+                decodeBatchedOutput(m_outputBuffer.data(), 0, batchSize);
+            auto endDecode = std::chrono::high_resolution_clock::now();
+
+            LOG_INFO("[BENCH] " << threads << " thread(s): preprocess "
+                << std::chrono::duration<double, std::milli>(endPre - startPre).count() / iterations << " ms, decode "
+                << std::chrono::duration<double, std::milli>(endDecode - startDecode).count() / iterations << " ms");
+
+            if (threads >= m_numThreads) break;
+        }
+    } catch (const Ort::Exception& e) {
+        LOG_CRITICAL("Parallel scaling benchmark failed: " << e.what());
+    }
+
+    cv::setNumThreads(m_numThreads);
+}
+
+void InferenceWorker::benchmarkMicroBatching() {
+    const int tunedCount = m_microBatchCount;
+
+    try {
+        const std::vector<cv::Mat>& tiles = splitImageIntoTiles(m_inputFrame);
+        if (m_tileConfig.skipEmptyTiles) dropEmptyTiles();
+        if (tiles.empty()) return;
+
+        const int iterations = 3;
+        double singleShotMs = 0.0;
+        for (int count : MICRO_BATCH_CANDIDATES) {
+            m_microBatchCount = count;
+            inferTiles(tiles); // first run at new slice shapes is not timed
+
+            auto start = std::chrono::high_resolution_clock::now();
+            for (int it = 0; it < iterations; ++it)
+                inferTiles(tiles);
+            auto end = std::chrono::high_resolution_clock::now();
+            double ms = std::chrono::duration<double, std::milli>(end - start).count() / iterations;
+
+            if (count == 1) singleShotMs = ms;
+            LOG_INFO("[BENCH] " << count << " micro-batch(es) over " << tiles.size() << " tiles: " << ms
+                << " ms preprocess+run+decode (single-shot " << singleShotMs << " ms, speedup " << singleShotMs / ms << "x)");
+        }
+    } catch (const Ort::Exception& e) {
+        LOG_CRITICAL("Micro-batch benchmark failed: " << e.what());
+    }
+
+    m_microBatchCount = tunedCount;
+}
+
+void InferenceWorker::benchmarkNativeTiling() {
+    const TileGridConfig configured = m_tileConfig;
+    const int tunedCount = m_microBatchCount;
+    const int tuningTrial = m_tuningTrial;
+
+    auto measure = [&](bool native) {
+        m_tileConfig.nativeResolution = native;
+        applyModelInputSize();
+        m_microBatchCount = 1; // same single-shot path for both
+
+        const std::vector<cv::Mat>& tiles = splitImageIntoTiles(m_inputFrame);
+        if (m_tileConfig.skipEmptyTiles) dropEmptyTiles();
+        if (tiles.empty()) return;
+
+        const int iterations = 3;
+        inferTiles(tiles); // binds and warms the session at this input size
+
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int it = 0; it < iterations; ++it)
+            preprocessBatchedImages(tiles, m_inputBuffer.data());
+        auto mid = std::chrono::high_resolution_clock::now();
+        for (int it = 0; it < iterations; ++it)
+            inferTiles(tiles);
+        auto end = std::chrono::high_resolution_clock::now();
+
+        LOG_INFO("[BENCH] " << (native ? "native" : "resized") << " tiling: " << m_tileGrid.cols << "x" << m_tileGrid.rows
+            << " grid of " << m_tileGrid.tileWidth << "x" << m_tileGrid.tileHeight << ", " << tiles.size() << " tiles at "
+            << m_inputWidth << "x" << m_inputHeight << ": preprocess "
+            << std::chrono::duration<double, std::milli>(mid - start).count() / iterations << " ms, preprocess+run+decode "
+            << std::chrono::duration<double, std::milli>(end - mid).count() / iterations << " ms");
+    };
+
+    try {
+        measure(false);
+        measure(true);
+    } catch (const Ort::Exception& e) {
+        LOG_CRITICAL("Native tiling benchmark failed: " << e.what());
+    }
+
+    m_tileConfig = configured;
+    applyModelInputSize();
+    m_microBatchCount = tunedCount;
+    m_tuningTrial = tuningTrial;
+}
+
+void InferenceWorker::benchmarkCascade() {
+    const TileGridConfig configured = m_tileConfig;
+    const int tunedCount = m_microBatchCount;
+    const bool drawResults = m_drawResults;
+    m_drawResults = false;
+    m_microBatchCount = 1; // same single-shot path for both
+
+    struct Pass {
+        double ms = 0.0;
+        size_t tiles = 0;
+        std::vector<cv::Rect> boxes;
+    };
+
+    auto measure = [&](bool cascade) {
+        Pass pass;
+        m_tileConfig.cascade = cascade;
+        m_lastDetections.clear();
+
+        auto start = std::chrono::high_resolution_clock::now();
+        const std::vector<cv::Mat>& tiles = splitImageIntoTiles(m_inputFrame);
+        if (m_tileConfig.skipEmptyTiles) dropEmptyTiles();
+        if (cascade && !tiles.empty()) dropTilesWithoutCandidates(m_inputFrame);
+        if (!tiles.empty()) {
+            inferTiles(tiles);
+            processBatchedOutput(static_cast<int>(tiles.size()));
+        }
+        pass.ms = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+        pass.tiles = tiles.size();
+        pass.boxes = m_lastDetections.boxes;
+        return pass;
+    };
+
+    try {
+        measure(false); // warm-up at this batch size
+        const Pass full = measure(false);
+        const Pass cascade = measure(true);
+
+        // full-tiling detections the cascade found again, the cost of the skipped tiles
+        size_t matched = 0;
+        for (const cv::Rect& box : full.boxes) {
+            for (const cv::Rect& other : cascade.boxes) {
+                const double overlap = (box & other).area();
+                if (overlap > 0.5 * (box.area() + other.area() - overlap)) {
+                    ++matched;
+                    break;
                 }
             }
-            
-            // Filter by confidence threshold
-            if (maxClassScore > CONFIDENCE_THRESHOLD) {
-                allConfidences.push_back(maxClassScore);
-                allClassIds.push_back(maxClassId);
-                
-                //cv::Rect box = createBoxForQuadrant(cx, cy, w, h, scaleX, scaleY, b, halfWidth, halfHeight);
-                cv::Rect box = createBoxForQuadrant(cx, cy, w, h, scaleX, scaleY, b + 1, tileWidth, tileHeight);
-                allBoxes.push_back(box);
-				allCentroids.push_back(cv::Point(cx * scaleX, cy * scaleY));
-            }
         }
+
+        // compute in model input pixels: the tiles at the tile input size plus one coarse frame
+        const double tilePixels = static_cast<double>(m_inputWidth) * m_inputHeight;
+        const double cascadePixels = cascade.tiles * tilePixels + static_cast<double>(MODEL_INPUT_SIZE) * MODEL_INPUT_SIZE;
+        LOG_INFO("[BENCH] cascade: full tiling " << full.tiles << " tiles, " << full.ms << " ms, " << full.boxes.size()
+            << " detections | cascade " << m_coarseRegions.size() << " regions, 1 coarse + " << cascade.tiles << " tiles, "
+            << cascade.ms << " ms, " << cascade.boxes.size() << " detections, recall "
+            << (full.boxes.empty() ? 100.0 : 100.0 * matched / full.boxes.size()) << "%, compute "
+            << (full.tiles ? 100.0 * cascadePixels / (full.tiles * tilePixels) : 0.0) << "% of full");
+    } catch (const Ort::Exception& e) {
+        LOG_CRITICAL("Cascade benchmark failed: " << e.what());
     }
-    
-    // Apply global NMS to remove overlapping detections between quadrants
-    std::vector<int> finalIndices;
-    cv::dnn::NMSBoxes(allBoxes, allConfidences, CONFIDENCE_THRESHOLD, OVERLAP_THRESHOLD, finalIndices);
 
-    if (finalIndices.empty()) {
-        LOG_INFO("No valid detections found after NMS.");
-        return {};
-	}
+    m_tileConfig = configured;
+    m_microBatchCount = tunedCount;
+    m_drawResults = drawResults;
+    m_lastDetections.clear();
+}
 
-    LOG_INFO("Valid detections found - " << finalIndices.size());
-    
-    // Draw results
-    std::vector<cv::Rect> centroids = drawBoxes(allBoxes, allClassIds, allConfidences, finalIndices);
-	std::vector<cv::Rect> path = shortestPath(centroids);
+void InferenceWorker::predict(const cv::Mat& frame, const TileGridConfig& config) {
+    QMutexLocker locker(&m_mutex);
+
+    // always answer, the UI waits for frameProcessed before taking the next request
+    if (!m_session) {
+        LOG_WARNING("Inference service is not initialized. Cannot run inference.");
+        emit frameProcessed(cv::Mat(), DetectionResult());
+        return;
+    }
     
-    for (int i = 0; i < path.size() - 1; ++i) {
-        cv::line(m_inputFrame,  (path[i].tl() + path[i].br()) * 0.5, (path[i + 1].tl() + path[i + 1].br()) * 0.5, cv::Scalar(255, 0, 0), 2);
+    if (frame.empty()) {
+        LOG_WARNING("Input frame is empty. Cannot run inference.");
+        emit frameProcessed(cv::Mat(), DetectionResult());
+        return;
 	}
 
-    return path;
+    // drawing goes into a copy, the caller's image stays as captured and hashes the same on a re-run
+    m_sourceFrame = frame;
+    detect(m_drawResults ? frame.clone() : frame, config);
+    emit frameProcessed(m_inputFrame, m_lastDetections);
+
+    if (get_saveOutput_flag())
+        saveResultImage();
 }
 
-void InferenceWorker::predict() {
+void InferenceWorker::setThresholds(float confidence, float iou) {
     QMutexLocker locker(&m_mutex);
-    
-    if (m_inputFrame.empty()) {
-        LOG_WARNING("Input frame is empty. Cannot run inference.");
+
+    m_nmsConfig.scoreThreshold = std::clamp(confidence, MIN_CONFIDENCE_THRESHOLD, 1.0f);
+    m_nmsConfig.iouThreshold = std::clamp(iou, 0.0f, 1.0f);
+    if (m_nmsConfig.scoreThreshold != confidence)
+        LOG_WARNING("Confidence threshold " << confidence << " is outside [" << MIN_CONFIDENCE_THRESHOLD << ", 1], using " << m_nmsConfig.scoreThreshold);
+    LOG_INFO("Thresholds set to confidence " << m_nmsConfig.scoreThreshold << ", IoU " << m_nmsConfig.iouThreshold);
+
+    // a cache hit or a failed run leaves no raw candidates, the new cut then applies from the next prediction
+    if (m_lastBatchSize < 0 || m_sourceFrame.empty()) {
+        LOG_INFO("No raw candidates of a previous prediction, thresholds apply from the next one");
         return;
-	}
+    }
+
+    START_TIMER(refilter);
+    m_inputFrame = m_drawResults ? m_sourceFrame.clone() : m_sourceFrame;
+    m_lastDetections.clear();
+    processBatchedOutput(m_lastBatchSize);
+    END_TIMER(refilter);
+    LOG_INFO("Valid detections found - " << m_lastDetections.boxes.size());
+
+    emit detectionsRefiltered(m_inputFrame, m_lastDetections);
+
+    if (get_saveOutput_flag())
+        saveResultImage();
+}
+
+void InferenceWorker::setInput(const cv::Mat& frame, const TileGridConfig& config) {
+    m_inputFrame = frame;
+    m_frameWidth = frame.cols;
+    m_frameHeight = frame.rows;
+    m_tileConfig = config;
+    applyModelInputSize();
+}
+
+const DetectionResult& InferenceWorker::runDetection(const cv::Mat& frame, const TileGridConfig& config) {
+    setInput(frame, config);
+    runBatchedModel(m_inputFrame);
+    return m_lastDetections;
+}
+
+const std::vector<cv::Rect>& InferenceWorker::detect(const cv::Mat& frame, const TileGridConfig& config) {
+    setInput(frame, config);
+
+    // same pixels under the same model and settings: reuse the stored result, no ORT run
+    const bool useCache = m_detectionCache.enabled() && !get_benchDebug_flag();
+    uint64_t contentHash = 0, settingsHash = 0;
+    if (useCache) {
+        START_TIMER(cacheLookup);
+        contentHash = imageContentHash(m_inputFrame);
+        settingsHash = detectionSettingsHash();
+        DetectionResult cached;
+        const bool hit = m_detectionCache.load(contentHash, settingsHash, cached);
+        END_TIMER(cacheLookup);
+        if (hit) {
+            m_lastBatchSize = -1; // no raw candidates behind a cached result
+            m_lastDetections = cached;
+            if (m_drawResults)
+                drawDetections(m_lastDetections);
+            LOG_INFO("Detection cache hit, " << cached.boxes.size() << " detections reused");
+            return m_lastDetections.path;
+        }
+    }
 
 	START_TIMER(predictionTotal);
     // Use batched inference for better performance
     //runModel(m_inputFrame);
-    std::vector<cv::Rect> boxCentroids = runBatchedModel(m_inputFrame);
+    runBatchedModel(m_inputFrame);
 	END_TIMER(predictionTotal);
-    
-    emit frameProcessed(m_inputFrame, boxCentroids);
-}
\ No newline at end of file
+    LOG_INFO("Prediction #" << ++m_predictionCount << " done on the warm session: " << m_lastDetections.boxes.size()
+        << " valid detections over " << std::max(m_lastBatchSize, 0) << " tiles");
+
+    if (useCache && m_lastDetectionsValid)
+        m_detectionCache.store(contentHash, settingsHash, m_lastDetections);
+
+    return m_lastDetections.path;
+}
+
+void InferenceWorker::runBenchmarks(const cv::Mat& frame, const TileGridConfig& config) {
+    QMutexLocker locker(&m_mutex);
+    setInput(frame, config);
+
+    benchmarkPreprocess(splitImageIntoTiles(m_inputFrame), m_inputWidth, m_inputHeight);
+    benchmarkParallelScaling();
+    benchmarkNms(m_inputFrame.size(), m_nmsConfig);
+    benchmarkMicroBatching();
+    benchmarkNativeTiling();
+    benchmarkCascade();
+    benchmarkThreadBudgets();
+    benchmarkSessionCreation();
+
+    // tiles and candidates left behind belong to the benchmarks, not to a prediction setThresholds could refilter
+    m_lastBatchSize = -1;
+    m_lastDetections.clear();
+}
+
+void InferenceWorker::benchmarkSessionCreation() {
+    const std::string modelPath = modelPathFor(m_precision);
+    const RoleThreads threads = threadsForRole(m_threadRole, m_threadRoleIndex);
+    Ort::SessionOptions options;
+    options.SetIntraOpNumThreads(threads.intraOpThreads);
+    options.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_ALL);
+
+    auto timeCreate = [&](bool useCache) {
+        std::unique_ptr<MappedFile> mapping;
+        auto start = std::chrono::high_resolution_clock::now();
+        std::unique_ptr<Ort::Session> session = createSession(modelPath, options,
+            useCache ? optimizedModelCachePath(modelPath, m_modelHash) : std::string(), mapping);
+        auto end = std::chrono::high_resolution_clock::now();
+        return std::chrono::duration<double, std::milli>(end - start).count();
+    };
+
+    try {
+        // the running session already wrote the cache, both runs see a warm file cache
+        const double onnxMs = timeCreate(false);
+        const double cachedMs = timeCreate(true);
+        LOG_INFO("[BENCH] session creation: ONNX + optimization " << onnxMs << " ms, ORT-format cache " << cachedMs
+            << " ms (" << onnxMs / std::max(cachedMs, 1e-3) << "x faster)");
+    } catch (const std::exception& e) {
+        LOG_CRITICAL("Session creation benchmark failed: " << e.what());
+    }
+}
+
+void InferenceWorker::benchmarkThreadBudgets() {
+    const ThreadBudgetConfig configured = threadBudgetConfig();
+    const int cores = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    const cv::Mat frame = m_inputFrame;
+    const int iterations = 3;
+
+    // no reserve, the configured one and half the machine, each with and without spinning
+    std::vector<int> reserves = { 0, reservedCoresFor(configured), cores / 2 };
+    std::sort(reserves.begin(), reserves.end());
+    reserves.erase(std::unique(reserves.begin(), reserves.end()), reserves.end());
+
+    for (int reserved : reserves) {
+        for (bool spinning : { true, false }) {
+            ThreadBudgetConfig config = configured;
+            config.reservedCores = reserved;
+            if (m_threadRole == ThreadRole::LiveInference) config.liveSpinning = spinning;
+            else config.macroSpinning = spinning;
+            setThreadBudgetConfig(config);
+            if (!reloadSession()) continue;
+
+            try {
+                detectBoxes(frame, m_tileConfig); // first run at the new thread counts is not timed
+
+                // UI and camera threads running meanwhile (not under --bench) show what they got in their frame counters
+                const uint64_t uiStart = uiFrameCount();
+                const uint64_t previewStart = previewFrameCount();
+                auto start = std::chrono::high_resolution_clock::now();
+                for (int it = 0; it < iterations; ++it)
+                    detectBoxes(frame, m_tileConfig);
+                auto end = std::chrono::high_resolution_clock::now();
+
+                const double ms = std::chrono::duration<double, std::milli>(end - start).count();
+                const uint64_t uiFrames = uiFrameCount() - uiStart;
+                const uint64_t previewFrames = previewFrameCount() - previewStart;
+                if (uiFrames + previewFrames > 0)
+                    LOG_INFO("[BENCH] threads " << describeThreadBudget(config) << ": " << ms / iterations << " ms per detection, UI "
+                        << uiFrames * 1000.0 / ms << " fps, preview " << previewFrames * 1000.0 / ms << " fps");
+                else
+                    LOG_INFO("[BENCH] threads " << describeThreadBudget(config) << ": " << ms / iterations << " ms per detection");
+            } catch (const std::exception& e) {
+                LOG_CRITICAL("Thread budget benchmark failed: " << e.what());
+            }
+        }
+    }
+
+    setThreadBudgetConfig(configured);
+    reloadSession();
+    m_inputFrame = frame;
+}
+
+std::vector<cv::Rect> InferenceWorker::detectBoxes(const cv::Mat& frame, const TileGridConfig& config) {
+    setInput(frame, config);
+
+    std::vector<cv::Rect> boxes;
+    try {
+        const std::vector<cv::Mat>& tiles = splitImageIntoTiles(m_inputFrame);
+        if (m_tileConfig.skipEmptyTiles) dropEmptyTiles();
+        if (tiles.empty()) return boxes;
+
+        const int batchSize = static_cast<int>(tiles.size());
+        inferTiles(tiles);
+        collectDetections(batchSize);
+
+        boxes.reserve(m_keep.size());
+        for (int idx : m_keep) boxes.push_back(m_allBoxes[idx]);
+    } catch (const Ort::Exception& e) {
+        LOG_CRITICAL("ONNX Runtime inference failed: " << e.what());
+    }
+
+    return boxes;
+}
+
+void InferenceWorker::setLiveSource(std::shared_ptr<LatestFrameSlot> slot, int cameraType, const TileGridConfig& config) {
+    QMutexLocker locker(&m_mutex);
+    m_liveSlot = std::move(slot);
+    m_liveCameraType = cameraType;
+    m_liveConfig = config;
+}
+
+void InferenceWorker::runLive() {
+    std::shared_ptr<LatestFrameSlot> slot;
+    {
+        QMutexLocker locker(&m_mutex);
+        slot = m_liveSlot;
+    }
+    if (!slot) return;
+
+    if (!m_session) {
+        LOG_WARNING("Inference service is not initialized. Live detection on camera " << m_liveCameraType << " is unavailable.");
+        return;
+    }
+
+    LOG_INFO("Live detection started on camera " << m_liveCameraType);
+    int64_t processed = 0;
+
+    // frames that arrive while a detection runs overwrite each other in the slot, only the newest is taken next
+    cv::Mat frame;
+    int64_t capturedAtMs = 0;
+    while (slot->take(frame, capturedAtMs)) {
+        std::vector<cv::Rect> boxes;
+        {
+            QMutexLocker locker(&m_mutex);
+            boxes = detectBoxes(frame, m_liveConfig);
+        }
+        ++processed;
+        emit liveDetections(m_liveCameraType, boxes, capturedAtMs);
+    }
+
+    LOG_INFO("Live detection stopped on camera " << m_liveCameraType << ": " << processed << " frames detected, "
+        << slot->dropped() << " stale frames dropped");
+}
@@ -3,19 +3,68 @@
 
 #include <QObject>
 #include <QMutex>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
 #include <opencv2/opencv.hpp>
 #include <onnxruntime_cxx_api.h>
 
+#include "decode.h"
+#include "detectioncache.h"
+#include "latestframe.h"
+#include "modelcache.h"
+#include "nms.h"
+#include "threadbudget.h"
+#include "tiling.h"
+#include "utils.h"
 
-#define CONFIDENCE_THRESHOLD 0.2f
+
+#define CONFIDENCE_THRESHOLD 0.2f // defaults, setThresholds() changes them at runtime
 #define OVERLAP_THRESHOLD 0.2f
-#define TILE_FACTOR 4
+#define MIN_CONFIDENCE_THRESHOLD 0.05f // decode floor, candidates above it are kept so the cut can move later
+#define MODEL_INPUT_SIZE 640 // input side for resized tiles, native tiles set their own
+
+// Detections decoded from one tile of the batch output, kept per tile so tiles can be decoded in parallel
+struct TileDetections {
+    DetectionCandidates candidates; // model-space hits, scores and class ids are used as is
+    std::vector<cv::Rect> boxes;    // candidates remapped to frame pixels
+};
+
+// One slice of the tile batch in the pipelined path. Tensors are views into the worker's preallocated
+// IO buffers, finished is set from ORT's thread pool when the slice's RunAsync completes.
+struct MicroBatch {
+    int first = 0; // batch index of the slice's first tile
+    int count = 0;
+    Ort::Value input{ nullptr };
+    Ort::Value output{ nullptr };
+    const char* inputName = nullptr;
+    const char* outputName = nullptr;
+
+    std::mutex mutex;
+    std::condition_variable done;
+    bool finished = true;
+    std::string error;
+};
+
+// IO of one batch size: tensors over the front of the shared buffers and a binding made once for them
+struct BatchBinding {
+    Ort::Value input{ nullptr };
+    Ort::Value output{ nullptr };
+    Ort::IoBinding binding{ nullptr };
+};
+
+enum class ModelPrecision {
+    FP32,
+    INT8 // static QDQ model calibrated on macro_img/ by tools/quantize_int8.py
+};
 
 class InferenceWorker : public QObject {
     Q_OBJECT
 
 public:
-    explicit InferenceWorker(int frameWidth, int frameHeight, cv::Mat& img);
+    // Long-lived: created once, moved to its own thread, then initialize() loads and warms the
+    // session before any predict() request is taken off the thread's event queue
+    explicit InferenceWorker(QObject* parent = nullptr);
     ~InferenceWorker();
 
     void clearInput() {
@@ -24,8 +73,51 @@ public:
         m_outputFrame.release();
     }
 
+    // picked at load time, so set before initialize(). Defaults to the int8Model flag.
+    void setModelPrecision(ModelPrecision precision) { m_precision = precision; }
+    ModelPrecision modelPrecision() const { return m_precision; }
+    static std::string modelPathFor(ModelPrecision precision);
+    bool isReady() const { return m_session != nullptr; }
+    // results of macro predictions are kept as sidecars in dir and reused for identical images, "" = off
+    void setDetectionCacheDir(const std::string& dir) { m_detectionCache.setDirectory(dir); }
+    // thread counts, spinning and pinning come from the thread budget for this role, set before initialize()
+    void setThreadRole(ThreadRole role, int index = 0) { m_threadRole = role; m_threadRoleIndex = index; }
+    // off: detect() leaves the frame untouched and the receiver renders the emitted detections itself
+    void setDrawResults(bool draw) { m_drawResults = draw; }
+    // read once in the constructor, safe to call from any thread
+    const std::vector<std::string>& classNames() const { return m_classNames; }
+
+    // Synchronous tiled detection on the calling thread, draws the results into frame unless drawing is off.
+    // predict() wraps it for the UI, the model comparison tool calls it directly.
+    // With a cache directory set, a frame seen before under the same model and settings skips ORT.
+    // Returns the traversal path, valid until the next prediction.
+    const std::vector<cv::Rect>& detect(const cv::Mat& frame, const TileGridConfig& config);
+    // detect() without the cache and log line: what --self-test runs to count allocations and
+    // --compare-models to get boxes with their classes. Valid until the next prediction.
+    const DetectionResult& runDetection(const cv::Mat& frame, const TileGridConfig& config);
+    // Same detection without drawing, ordering or per-stage timers: the kept boxes in frame pixels
+    std::vector<cv::Rect> detectBoxes(const cv::Mat& frame, const TileGridConfig& config);
+
+    // Live mode: set before runLive(). The worker detects on whatever frame the camera last put in
+    // slot and reports each result with liveDetections(cameraType, ...).
+    void setLiveSource(std::shared_ptr<LatestFrameSlot> slot, int cameraType, const TileGridConfig& config);
+
     void readClassNames();
     void initializeONNXRuntime();
+    // Session from the ORT-format cache at cachePath when there is a usable one, otherwise from the ONNX file,
+    // saving the optimized graph there on the way ("" = no cache). mapping receives the cached bytes the session reads from.
+    std::unique_ptr<Ort::Session> createSession(const std::string& modelPath, const Ort::SessionOptions& options,
+        const std::string& cachePath, std::unique_ptr<MappedFile>& mapping);
+    void warmUp();
+    // pins the worker thread and sizes the OpenCV pool for m_threadRole
+    void applyThreadRole();
+    // new session with the current thread budget, ORT thread pools are fixed at session creation.
+    // false (logged) when it could not be built, the current session is kept then.
+    bool reloadSession();
+    // binding for batchSize, binds every batch size up to the full tile grid the first time
+    Ort::IoBinding& prepareBindings(int batchSize);
+    // switches the model input between MODEL_INPUT_SIZE and the native tile size of m_tileConfig
+    void applyModelInputSize();
 
 	// single image processing
 	// TODO: also show path for single image processing
@@ -35,41 +127,154 @@ public:
     void runModel(cv::Mat& input);
 
 	// batched image processing
-    std::vector<cv::Mat> splitImageIntoQuadrants(const cv::Mat& image);
-    std::vector<float> preprocessBatchedImages(const std::vector<cv::Mat>& images);
-    std::vector<cv::Rect> processBatchedOutput(Ort::Value& output, cv::Mat& originalImage);
-    cv::Rect createBoxForQuadrant(float cx, float cy, float w, float h, float scale_x, float scale_y, int quadrant, int quadWidth, int quadHeight);
-    std::vector<cv::Rect> runBatchedModel(cv::Mat& input);
+    void setTileGridConfig(const TileGridConfig& config) { m_tileConfig = config; }
+    // frame and tiling of the next run, resizes the model input when the tile size changes
+    void setInput(const cv::Mat& frame, const TileGridConfig& config);
+    const std::vector<cv::Mat>& splitImageIntoTiles(const cv::Mat& image);
+    const std::vector<cv::Mat>& dropEmptyTiles();
+    // coarse pass of the cascade: whole frame at MODEL_INPUT_SIZE, drops the tiles no candidate touches
+    const std::vector<cv::Mat>& dropTilesWithoutCandidates(const cv::Mat& image);
+    // keeps the batch entries flagged in m_tileOccupied, in grid order
+    size_t compactTiles();
+    // count < 0 means every image from first on
+    void preprocessBatchedImages(const std::vector<cv::Mat>& images, float* batchedInput, int first = 0, int count = -1);
+    // merge, NMS and path into m_lastDetections, drawn into m_inputFrame unless drawing is off
+    void processBatchedOutput(int batchSize);
+    // merges the decoded tiles into m_allBoxes/..., stitches seams and runs NMS, m_keep indexes the merged arrays
+    void collectDetections(int batchSize);
+    void decodeBatchedOutput(const float* outputData, int first, int count);
+    void decodeTile(const float* outputData, int batchIndex, float scaleX, float scaleY, TileDetections& detections);
+    // result in m_lastDetections
+    void runBatchedModel(cv::Mat& input);
+
+    // preprocess + run + decode of the batch, single Run or pipelined over m_microBatchCount slices
+    void inferTiles(const std::vector<cv::Mat>& tiles);
+    void runPipelined(const std::vector<cv::Mat>& tiles);
+    void prepareMicroBatches(int batchSize, int count);
+    void startMicroBatch(MicroBatch& batch);
+    std::string waitMicroBatch(MicroBatch& batch);
+    // online tuner: the first predictions try each micro-batch count, then the fastest per tile is kept
+    void recordMicroBatchTiming(double msPerTile);
 
 	// common processing
-    std::vector<cv::Rect> shortestPath(std::vector<cv::Rect>& centroids);
+    void shortestPath(const std::vector<cv::Rect>& centroids, std::vector<cv::Rect>& path);
     std::vector<cv::Rect> drawBoxes(std::vector<cv::Rect>& boxes, std::vector<int>& classIds,
         std::vector<float>& confidences, std::vector<int>& indices);
+    void drawPath(const std::vector<cv::Rect>& path);
+    void drawDetections(DetectionResult& detections);
+    // annotated copy of the last prediction to output.jpg on the background writer, see the saveOutput flag
+    void saveResultImage();
+    // model file, precision, thresholds and tiling: everything besides the pixels that shapes the result
+    uint64_t detectionSettingsHash() const;
+
+    // every benchmark below once on frame, what --bench runs. Slow: reloads the session several times.
+    void runBenchmarks(const cv::Mat& frame, const TileGridConfig& config);
+    // logs preprocess/decode timings for 1..N threads on the current input frame
+    void benchmarkParallelScaling();
+    // logs preprocess+run+decode latency for each micro-batch count against the single-shot Run
+    void benchmarkMicroBatching();
+    // logs tile count, preprocess and preprocess+run+decode time of resized vs native-resolution tiling
+    void benchmarkNativeTiling();
+    // logs tiles run, latency and recall of the cascade against full tiling on the current frame
+    void benchmarkCascade();
+    // reloads the session under a sweep of thread budgets and logs detection latency next to UI and preview FPS
+    void benchmarkThreadBudgets();
+    // logs session creation time from the ONNX file (full graph optimization) against the ORT-format cache
+    void benchmarkSessionCreation();
     
 public slots:
-    void predict();
+    void initialize();
+    void predict(const cv::Mat& frame, const TileGridConfig& config);
+    // New confidence / IoU cut. Re-runs only filtering, NMS and path planning on the raw candidates of the
+    // last prediction and emits detectionsRefiltered, the model is not run again.
+    void setThresholds(float confidence, float iou);
+    // blocks the worker thread until the live slot is closed, latest frame wins
+    void runLive();
 
 signals:
-    void frameProcessed(const cv::Mat& frame, const std::vector<cv::Rect>& boxCentroids);
+    void serviceReady(bool ok);
+    // frame is the undrawn input when drawing is off, detections.path is the traversal order
+    void frameProcessed(const cv::Mat& frame, const DetectionResult& detections);
+    void detectionsRefiltered(const cv::Mat& frame, const DetectionResult& detections);
+    // capturedAtMs is the frame's steadyClockMs() stamp, so the receiver can measure frame -> overlay latency
+    void liveDetections(int cameraType, const std::vector<cv::Rect>& boxes, qint64 capturedAtMs);
 
 private:
     // ONNX Runtime components
     std::unique_ptr<Ort::Env> m_env;
+    std::unique_ptr<MappedFile> m_modelMapping; // cached ORT-format model the session reads from, outlives it
     std::unique_ptr<Ort::Session> m_session;
     Ort::AllocatorWithDefaultOptions m_allocator;
     Ort::MemoryInfo m_memoryInfo = Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault);
 
+    // Preallocated IO: sized for the largest batch seen so far, with one binding per batch size, so skipping
+    // empty tiles only picks another binding. Preprocessing writes into m_inputBuffer and decoding reads
+    // m_outputBuffer, no per-run tensors.
+    std::vector<float> m_inputBuffer;
+    std::vector<float> m_outputBuffer;
+    std::vector<BatchBinding> m_batchBindings; // index = batch size - 1
+
+    // Pipelined micro-batches, cut from the same buffers. 1 = one Run over the whole batch.
+    Ort::RunOptions m_runOptions;
+    std::vector<std::unique_ptr<MicroBatch>> m_microBatches;
+    int m_microBatchCount = 1;
+    int m_microBatchTotal = 0; // batch size and count the slices were cut for
+    int m_microBatchCut = 0;
+    const float* m_microInputBase = nullptr;
+    const float* m_microOutputBase = nullptr;
+    int m_tuningTrial = 0;
+    std::vector<double> m_microBatchMsPerTile;
+
     // Model info
     std::string m_inputName;
     std::string m_outputName;
     std::vector<int64_t> m_inputShape;
     int64_t m_inputHeight;
     int64_t m_inputWidth;
+    int64_t m_outputChannels = 0; // 4 box values + one score per class
+    int64_t m_numPredictions = 0; // anchors per image
 
     // Qt and OpenCV components
     QMutex m_mutex;
     int m_frameWidth;
     int m_frameHeight;
+    int m_numThreads; // OpenCV threads used for per-tile preprocess and decode
+    ThreadRole m_threadRole = ThreadRole::MacroInference;
+    int m_threadRoleIndex = 0;
+    int m_predictionCount = 0;
+    ModelPrecision m_precision;
+    TileGridConfig m_tileConfig;
+    DetectionCache m_detectionCache;
+    uint64_t m_modelHash = 0;
+    bool m_drawResults = true;
+    DetectionResult m_lastDetections; // kept boxes and path of the last prediction
+    bool m_lastDetectionsValid = false; // false when that run failed, nothing gets cached then
+    cv::Mat m_sourceFrame;              // undrawn input of the last prediction, redrawn on a threshold change
+    int m_lastBatchSize = -1;           // batch entries whose raw candidates are in m_tileDetections, -1 = none
+
+    // live detection source, see setLiveSource()
+    std::shared_ptr<LatestFrameSlot> m_liveSlot;
+    int m_liveCameraType = NONE;
+    TileGridConfig m_liveConfig;
+    NmsConfig m_nmsConfig;
+    TileGrid m_tileGrid; // layout of the last split, used to map boxes back
+    TileContentConfig m_tileContentConfig;
+    std::vector<cv::Mat> m_tiles;    // batch entries, only the occupied tiles once dropEmptyTiles ran
+    std::vector<int> m_batchTileIds; // grid index of each batch entry
+    std::vector<char> m_tileOccupied;
+    std::vector<TileDetections> m_tileDetections;
+    // merge and NMS scratch of collectDetections, cleared but kept between predictions
+    std::vector<cv::Rect> m_allBoxes;
+    std::vector<float> m_allConfidences;
+    std::vector<int> m_allClassIds;
+    std::vector<int> m_allTileIds;
+    std::vector<int> m_keep;
+    std::vector<char> m_pathUsed;
+    // coarse pass IO, separate from the tile bindings so those keep their shape
+    std::vector<float> m_coarseInput;
+    std::vector<float> m_coarseOutput;
+    DetectionCandidates m_coarseCandidates;
+    std::vector<cv::Rect> m_coarseRegions;
     cv::Mat m_inputFrame;
     cv::Mat m_outputFrame;
     std::vector<std::string> m_classNames;
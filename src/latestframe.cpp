@@ -0,0 +1,50 @@
+#include "latestframe.h"
+
+int64_t steadyClockMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+int64_t steadyClockUs() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void LatestFrameSlot::put(const cv::Mat& frame, int64_t capturedAtMs) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_closed) return;
+        if (m_pending) ++m_dropped;
+        m_frame = frame;
+        m_capturedAtMs = capturedAtMs;
+        m_pending = true;
+    }
+    m_frameAvailable.notify_one();
+}
+
+bool LatestFrameSlot::take(cv::Mat& frame, int64_t& capturedAtMs) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_frameAvailable.wait(lock, [this] { return m_pending || m_closed; });
+    if (m_closed) return false;
+
+    // hand the buffer over, the slot doesn't keep the camera's frame alive any longer than needed
+    frame = m_frame;
+    m_frame.release();
+    capturedAtMs = m_capturedAtMs;
+    m_pending = false;
+    return true;
+}
+
+void LatestFrameSlot::close() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_closed = true;
+        m_frame.release();
+    }
+    m_frameAvailable.notify_all();
+}
+
+int64_t LatestFrameSlot::dropped() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_dropped;
+}
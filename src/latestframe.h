@@ -0,0 +1,43 @@
+#ifndef LATESTFRAME_H
+#define LATESTFRAME_H
+
+#include <opencv2/core.hpp>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+// Milliseconds on the steady clock, used to stamp frames so the UI can measure frame -> overlay latency
+int64_t steadyClockMs();
+// same clock in microseconds, for frame pacing and interval statistics
+int64_t steadyClockUs();
+
+// Single-frame mailbox between a camera and a live detector. The camera overwrites the slot with
+// every frame, the detector takes the newest one when it is free: frames it did not get to are
+// dropped (and counted), never queued, so detection always runs on the most recent image.
+class LatestFrameSlot {
+public:
+    // frame is held by reference count, the producer must not write into it afterwards
+    void put(const cv::Mat& frame, int64_t capturedAtMs);
+
+    // Waits for a frame newer than the last one taken. Returns false once the slot is closed.
+    bool take(cv::Mat& frame, int64_t& capturedAtMs);
+
+    // wakes the consumer, take() returns false from now on
+    void close();
+
+    // frames overwritten before the consumer took them
+    int64_t dropped();
+
+private:
+    std::mutex m_mutex;
+    std::condition_variable m_frameAvailable;
+    cv::Mat m_frame;
+    int64_t m_capturedAtMs = 0;
+    bool m_pending = false;
+    bool m_closed = false;
+    int64_t m_dropped = 0;
+};
+
+#endif // LATESTFRAME_H
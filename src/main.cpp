@@ -1,15 +1,61 @@
 #include <QApplication>
 #include "mainwindow.h"
 #include "utils.h"
+#include "asyncimagewriter.h"
+#include "benchmarks.h"
+#include "modelcomparison.h"
+#include "replaysource.h"
+#include "selftests.h"
+#include "threadbudget.h"
 
 int main(int argc, char* argv[]) {
 
     set_camDebug_flag(true);
 	set_fpsDebug_flag(true);
+    set_benchDebug_flag(false); // logs per-stage timings of each prediction, the benchmarks run with --bench
+    set_tileDumpDebug_flag(false); // writes inference tiles to tile_dump/ in the background
+    set_int8Model_flag(false); // loads the INT8 QDQ model made by tools/quantize_int8.py instead of FP32
+    set_saveOutput_flag(false); // writes the annotated macro prediction to output.jpg in the background
+
+    // cores left to the UI/capture threads, ORT spinning and pinning, see threadbudget.h
+    ThreadBudgetConfig threadBudget;
+    threadBudget.reservedCores = -1; // min(5, cores / 4)
+    threadBudget.macroSpinning = false;
+    threadBudget.liveSpinning = false;
+    threadBudget.pinThreads = false;
+    setThreadBudgetConfig(threadBudget);
+
+    // what the IMG camera slot replays: an image, a folder of frames or a video, looped
+    ReplaySourceConfig replay;
+    replay.enabled = false; // true: the micro cams replay it too instead of opening their devices
+    replay.path = "test_img.png";
+    replay.fps = 0.0; // 0 = each camera's own fps
+    setReplaySourceConfig(replay);
 
     // Initialize logger
     Logger::initialize(); 
 
+    // offline FP32 vs INT8 check on a folder of saved macro images, no UI
+    if (argc > 2 && std::string(argv[1]) == "--compare-models") {
+        int result = compareModels(argv[2]);
+        Logger::cleanup();
+        return result;
+    }
+
+    // kernel and pipeline benchmarks on one image (the replay source by default), no camera or UI
+    if (argc > 1 && std::string(argv[1]) == "--bench") {
+        int result = runBenchmarks(argc > 2 ? argv[2] : replaySourceConfig().path);
+        Logger::cleanup();
+        return result;
+    }
+
+    // allocation checks of the capture and inference loops, no camera or UI
+    if (argc > 1 && std::string(argv[1]) == "--self-test") {
+        int result = runSelfTests();
+        Logger::cleanup();
+        return result;
+    }
+
     LOG_INFO("Application starting up: " << (get_camDebug_flag() ? "reading image input" : "reading video input"));
 
     std::vector<int> cams = checkAvailableCameraConnections();
@@ -22,6 +68,7 @@ int main(int argc, char* argv[]) {
     int result = app.exec();
 
     LOG_INFO("Application shutting down");
+    AsyncImageWriter::instance().stop(); // flush pending debug dumps, no-op when none were written
     Logger::cleanup(); // Clean shutdown
     return result;
 }
\ No newline at end of file
@@ -18,13 +18,20 @@
 #include <QDebug>
 #include <QDialog>
 #include <QDir>
+#include <QFileDialog>
 #include <QDateTime>
+#include <QGraphicsSimpleTextItem>
+#include <QGraphicsLineItem>
+#include <QPen>
 #include "XYZStage.h"
 #include <opencv2/opencv.hpp>
 // or more specific includes:
 #include <opencv2/core.hpp>
 #include <opencv2/imgproc.hpp>
 
+#include <algorithm>
+#include <cmath>
+
 
 MainWindow::MainWindow(QWidget* parent)
     : QMainWindow(parent) {
@@ -97,7 +104,7 @@ MainWindow::MainWindow(QWidget* parent)
 	// FPS dialog setup
     QDialog* FpsDialog = new QDialog(this);
     FpsDialog->setWindowTitle("FPS Monitor");
-    FpsDialog->setFixedSize(150, 100);
+    FpsDialog->setFixedSize(260, 150);
 
     m_uiFPS = new QLabel("UI FPS: 0", FpsDialog);
     m_uiFPS->setAlignment(Qt::AlignRight);
@@ -111,11 +118,19 @@ MainWindow::MainWindow(QWidget* parent)
     m_microCam2FPS = new QLabel("micro cam1 FPS: 0", FpsDialog);
     m_microCam2FPS->setAlignment(Qt::AlignRight);
 
+    m_microCam1LiveFPS = new QLabel("microCam1 det FPS - 0", FpsDialog);
+    m_microCam1LiveFPS->setAlignment(Qt::AlignRight);
+
+    m_microCam2LiveFPS = new QLabel("microCam2 det FPS - 0", FpsDialog);
+    m_microCam2LiveFPS->setAlignment(Qt::AlignRight);
+
     QVBoxLayout* fpsLayout = new QVBoxLayout(FpsDialog);
     fpsLayout->addWidget(m_uiFPS);
     fpsLayout->addWidget(m_arducamFPS);
     fpsLayout->addWidget(m_microCam1FPS);
     fpsLayout->addWidget(m_microCam2FPS);
+    fpsLayout->addWidget(m_microCam1LiveFPS);
+    fpsLayout->addWidget(m_microCam2LiveFPS);
     FpsDialog->setLayout(fpsLayout);
     FpsDialog->move(QPoint(FpsDialog->width() + mainWidth, FpsDialog->height()));
 
@@ -131,6 +146,9 @@ MainWindow::MainWindow(QWidget* parent)
 
     setupTransformationMatrix();
 
+    // load the model in the background while the user sets up the cameras
+    setupInferenceService();
+
     // UI timer setup
     QTimer* uiUpdateTimer = new QTimer(this);
     connect(uiUpdateTimer, &QTimer::timeout, this, &MainWindow::renderLatestFrame);
@@ -159,6 +177,9 @@ MainWindow::~MainWindow() {
         m_macroImgInference.thrd->quit();
         m_macroImgInference.thrd->wait();
     }
+
+    stopLiveDetection(m_microCam1Live, m_microCam1Op);
+    stopLiveDetection(m_microCam2Live, m_microCam2Op);
     
     if (m_microCam1Op.camWorker) {
         m_microCam1Op.camWorker->stop();
@@ -345,6 +366,14 @@ QGroupBox* MainWindow::setupPositionUI() {
     m_z1 = new QLineEdit("-960");
     m_stepEdit = new QLineEdit("100");
 
+    TileGridConfig defaultTiling;
+    m_tileGridEdit = new QLineEdit(QString("%1x%2").arg(defaultTiling.cols).arg(defaultTiling.rows));
+    m_tileOverlapEdit = new QLineEdit(QString::number(defaultTiling.overlap));
+    m_confidenceEdit = new QLineEdit(QString::number(CONFIDENCE_THRESHOLD));
+    m_iouEdit = new QLineEdit(QString::number(OVERLAP_THRESHOLD));
+    connect(m_confidenceEdit, &QLineEdit::editingFinished, this, &MainWindow::onThresholdsEdited);
+    connect(m_iouEdit, &QLineEdit::editingFinished, this, &MainWindow::onThresholdsEdited);
+
     QVBoxLayout* positionLayout = new QVBoxLayout();
     positionLayout->addWidget(currentLabel);
     positionLayout->addWidget(m_xLabel);
@@ -357,6 +386,16 @@ QGroupBox* MainWindow::setupPositionUI() {
     positionLayout->addWidget(m_z1);
     positionLayout->addWidget(new QLabel("Step:"));
     positionLayout->addWidget(m_stepEdit);
+    positionLayout->addWidget(new QLabel("Tiles (cols x rows or native[:size], +cascade) / overlap:"));
+    QHBoxLayout* tilingLayout = new QHBoxLayout();
+    tilingLayout->addWidget(m_tileGridEdit);
+    tilingLayout->addWidget(m_tileOverlapEdit);
+    positionLayout->addLayout(tilingLayout);
+    positionLayout->addWidget(new QLabel("Confidence / IoU threshold:"));
+    QHBoxLayout* thresholdLayout = new QHBoxLayout();
+    thresholdLayout->addWidget(m_confidenceEdit);
+    thresholdLayout->addWidget(m_iouEdit);
+    positionLayout->addLayout(thresholdLayout);
 
     QGroupBox* positionBox = new QGroupBox();
     positionBox->setLayout(positionLayout);
@@ -371,26 +410,32 @@ QGroupBox* MainWindow::setupControlUI() {
     m_arducamOp.cameraBtn = new QPushButton("Start Camera");
     QPushButton* captureMacroImg = new QPushButton("Capture Macro Img");
     QPushButton* predictMacroImg = new QPushButton("Predict Macro pos");
+    QPushButton* openMacroImg = new QPushButton("Open Macro Img");
     m_goToPositionBtn = new QPushButton("Go To Position 1");
     m_microCam1Op.cameraBtn = new QPushButton("Start Duo Camera");
     QPushButton* captureMicroImg = new QPushButton("Capture Micro Img");
     m_predictMicroImg = new QPushButton("Path");
+    m_liveDetectBtn = new QPushButton("Start Live Detection");
 
     controlLayout->addWidget(m_arducamOp.cameraBtn);
     controlLayout->addWidget(captureMacroImg);
     controlLayout->addWidget(predictMacroImg);
+    controlLayout->addWidget(openMacroImg);
     controlLayout->addWidget(m_goToPositionBtn);
     controlLayout->addWidget(m_microCam1Op.cameraBtn);
     controlLayout->addWidget(captureMicroImg);
     controlLayout->addWidget(m_predictMicroImg);
+    controlLayout->addWidget(m_liveDetectBtn);
 
     connect(m_arducamOp.cameraBtn, &QPushButton::clicked, this, &MainWindow::onStartArducam);
     connect(captureMacroImg, &QPushButton::clicked, this, &MainWindow::onCaptureMacroImg);
     connect(predictMacroImg, &QPushButton::clicked, this, &MainWindow::onPredictMacroImg);
+    connect(openMacroImg, &QPushButton::clicked, this, &MainWindow::onOpenMacroImg);
     connect(m_goToPositionBtn, &QPushButton::clicked, this, &MainWindow::onGoToPosition1);
     connect(m_microCam1Op.cameraBtn, &QPushButton::clicked, this, &MainWindow::onStartDuocam);
     connect(captureMicroImg, &QPushButton::clicked, this, &MainWindow::onCaptureMicroImg);
     connect(m_predictMicroImg, &QPushButton::clicked, this, &MainWindow::onPredictMicroImg);
+    connect(m_liveDetectBtn, &QPushButton::clicked, this, &MainWindow::onToggleLiveDetection);
 
     QGroupBox* controlBox = new QGroupBox();
     controlBox->setLayout(controlLayout);
@@ -418,9 +463,8 @@ cv::Mat MainWindow::calculateTransformationMatrix(const std::vector<cv::Point2f>
 }
 
 void MainWindow::renderLatestFrame() {
-	QMutexLocker locker(&m_frameMutex);
-
 	m_uiFrameCount++;
+    countUiFrame();
     if (m_UITimer.elapsed() >= 1000) {
         QString fpsText = "UI FPS - " + QString::number(m_uiFrameCount);
         m_uiFPS->setText(fpsText);
@@ -428,73 +472,70 @@ void MainWindow::renderLatestFrame() {
         m_UITimer.restart();
     }
 
-    if (!m_latestArducamImage.isNull()) {
-        m_arducamPixmapItem->setPixmap(QPixmap::fromImage(m_latestArducamImage));
-    } else {
-        m_arducamPixmapItem->setPixmap(QPixmap());
-	}
-
-    if (!m_latestMicroCam1Image.isNull()) {
-        m_microCam1PixmapItem->setPixmap(QPixmap::fromImage(m_latestMicroCam1Image));
-    } else {
-        m_microCam1PixmapItem->setPixmap(QPixmap());
-    }
-
-    if (!m_latestMicroCam2Image.isNull()) {
-        m_microCam2PixmapItem->setPixmap(QPixmap::fromImage(m_latestMicroCam2Image));
-    } else {
-        m_microCam2PixmapItem->setPixmap(QPixmap());
-    }
+    // a view is only touched when its camera delivered a new frame since the last tick
+    updateFrame(m_arducamOp, m_arducamView, m_arducamPixmapItem, {}, "arducam", m_arducamFPS);
+    updateFrame(m_microCam1Op, m_microCam1View, m_microCam1PixmapItem, m_microCam1Live.boxes, "microCam1", m_microCam1FPS);
+    updateFrame(m_microCam2Op, m_microCam2View, m_microCam2PixmapItem, m_microCam2Live.boxes, "microCam2", m_microCam2FPS);
 }
 
 
-void MainWindow::updateFrame(const QImage& img, int camType) {
-	QMutexLocker locker(&m_frameMutex);
-    switch (camType) {
-    case ARDUCAM:
-    {
-        m_latestArducamImage = img;
-        m_arducamOp.frameCount++;
-        if (m_arducamOp.FPSTimer.elapsed() >= 1000) {
-			QString fpsText = "arducam FPS - " + QString::number(m_arducamOp.frameCount);
-            m_arducamFPS->setText(fpsText);
-            m_arducamOp.frameCount = 0;
-            m_arducamOp.FPSTimer.restart();
-        }
-        break;
-    }
+// last live detections (full resolution coordinates) over a preview frame scaled by sx, sy.
+// The frame is only detached when there is something to draw.
+static QImage withLiveOverlay(const QImage& img, const std::vector<cv::Rect>& boxes, double sx, double sy) {
+    if (boxes.empty()) return img;
 
-    case MICROCAM1: {
-        m_latestMicroCam1Image = img;
-        m_microCam1Op.frameCount++;
-        if (m_microCam1Op.FPSTimer.elapsed() >= 1000) {
-            QString fpsText = "microCam1 FPS - " + QString::number(m_microCam1Op.frameCount);
-            m_microCam1FPS->setText(fpsText);
-            m_microCam1Op.frameCount = 0;
-            m_microCam1Op.FPSTimer.restart();
-        }
-        break;
-    }
+    QImage overlay = img;
+    cv::Mat view(overlay.height(), overlay.width(), CV_8UC3, overlay.bits(), overlay.bytesPerLine());
+    for (const cv::Rect& box : boxes)
+        cv::rectangle(view, cv::Rect(cv::Point(cvRound(box.x * sx), cvRound(box.y * sy)), cv::Point(cvRound(box.br().x * sx), cvRound(box.br().y * sy))),
+            cv::Scalar(255, 0, 0), 2);
+    return overlay;
+}
 
-    case MICROCAM2: {
-        m_latestMicroCam2Image = img;
-        m_microCam2Op.frameCount++;
-        if (m_microCam2Op.FPSTimer.elapsed() >= 1000) {
-            QString fpsText = "microCam2 FPS - " + QString::number(m_microCam2Op.frameCount);
-            m_microCam2FPS->setText(fpsText);
-            m_microCam2Op.frameCount = 0;
-            m_microCam2Op.FPSTimer.restart();
-        }
-        break;
+void MainWindow::updateFrame(cameraOp& camera, QGraphicsView* view, QGraphicsPixmapItem* item, const std::vector<cv::Rect>& liveBoxes,
+    const QString& name, QLabel* fpsLabel) {
+    // previews at the resolution the view shows them at, scene coordinates stay full resolution pixels.
+    // Rounded up to 1/16 steps so zooming doesn't reallocate the camera's buffers on every wheel step.
+    const double viewScale = std::max(view->transform().m11(), view->transform().m22()) * view->devicePixelRatioF();
+    const double previewScale = std::min(1.0, std::ceil(viewScale * 16.0) / 16.0);
+    if (camera.camWorker && previewScale != camera.previewScale) {
+        camera.camWorker->setPreviewScale(previewScale);
+        camera.previewScale = previewScale;
     }
 
-    default:
-        LOG_WARNING("Unknown camera type received in updateFrame: " << camType);
-        break;
+    cv::Mat frame;
+    int64_t capturedAtMs = 0;
+    cv::Size fullSize;
+    if (!camera.frames || !camera.frames->takeLatest(frame, capturedAtMs, fullSize)) return;
+
+    // the QImage borrows the camera's buffer read-only, the pixmap conversion is the only copy
+    const double sx = static_cast<double>(frame.cols) / fullSize.width;
+    const double sy = static_cast<double>(frame.rows) / fullSize.height;
+    QImage image(static_cast<const uchar*>(frame.data), frame.cols, frame.rows, frame.step, QImage::Format_RGB888);
+    item->setPixmap(QPixmap::fromImage(withLiveOverlay(image, liveBoxes, sx, sy)));
+    item->setTransform(QTransform::fromScale(1.0 / sx, 1.0 / sy));
+
+    countPreviewFrame();
+    camera.frameCount++;
+    camera.latencySumMs += steadyClockMs() - capturedAtMs;
+    if (camera.FPSTimer.elapsed() >= 1000) {
+        // shown / captured per second, capture jitter and age of a frame when it reaches the screen
+        const qint64 latencyMs = camera.latencySumMs / camera.frameCount;
+        const float captureFps = camera.camWorker ? camera.camWorker->measuredFps() : 0.0f;
+        const float jitterMs = camera.camWorker ? camera.camWorker->frameJitterMs() : 0.0f;
+        fpsLabel->setText(QString("%1 FPS - %2/%3, jitter %4 ms, age %5 ms").arg(name).arg(camera.frameCount)
+            .arg(captureFps, 0, 'f', 0).arg(jitterMs, 0, 'f', 1).arg(latencyMs));
+        if (get_fpsDebug_flag())
+            LOG_INFO("[PREVIEW] " << name.toStdString() << ": " << camera.frameCount << " frames shown of " << captureFps
+                << " captured, jitter " << jitterMs << " ms, capture -> display " << latencyMs << " ms, "
+                << camera.frames->overwritten() << "/" << camera.frames->published() << " frames overwritten unseen");
+        camera.frameCount = 0;
+        camera.latencySumMs = 0;
+        camera.FPSTimer.restart();
     }
-    
 }
 
+
 void MainWindow::updatePositionDisplay() {
     // Check if values have changed to avoid unnecessary updates
     if (m_prevX != globle_vars.current_x ||
@@ -520,20 +561,19 @@ void MainWindow::onStartArducam() {
         // Already running - stop!
         LOG_INFO("stopping arducam");
         m_arducamOp.toggleCamera();
-        {
-            QMutexLocker locker(&m_frameMutex);
-            m_latestArducamImage = QImage();
-        }
+        m_arducamPixmapItem->setPixmap(QPixmap());
         m_arducamView->resetTransform();
         m_arducamOp.cameraBtn->setText("Start Arducam");
 		m_currentMacroImg.release();
 		m_macroImgPath.clear();
 		m_macroImgPath.shrink_to_fit();
+        clearMacroOverlay();
 		m_arducamFPS->setText("arducam FPS - 0");
         return;
     }
 
     LOG_INFO("starting arducam");
+    clearMacroOverlay(); // the last prediction's boxes don't belong on the live feed
 
     m_arducamOp.thrd = new QThread(this);
 
@@ -542,11 +582,12 @@ void MainWindow::onStartArducam() {
 
 	m_arducamOp.camWorker = new CameraWorker(IMG, 0, 3840, 2160, 20);// camIndex is 0 for arducam, 1 for microcam1 and 2 for microcam2
     m_arducamOp.camWorker->moveToThread(m_arducamOp.thrd);
+    m_arducamOp.frames = std::make_shared<TripleFrameBuffer>();
+    m_arducamOp.camWorker->setFrameBuffer(m_arducamOp.frames);
 
 	m_arducamView->resetTransform();
     m_arducamView->scale((float)m_arducamView->width()/ m_arducamOp.camWorker->getFrameWidth(), (float)m_arducamView->height() / m_arducamOp.camWorker->getFrameHeight());
     connect(m_arducamOp.thrd, &QThread::started, m_arducamOp.camWorker, &CameraWorker::process); 
-    connect(m_arducamOp.camWorker, &CameraWorker::frameReady, this, &MainWindow::updateFrame, Qt::QueuedConnection); 
     connect(m_arducamOp.thrd, &QThread::finished, m_arducamOp.camWorker, &QObject::deleteLater); 
     
     m_arducamOp.cameraBtn->setText("Stop Camera");
@@ -560,13 +601,11 @@ void MainWindow::onStartDuocam() {
     if (m_microCam1Op.thrd || m_microCam2Op.thrd) {
         // Already running - stop!
         LOG_INFO("stopping Duo cams");
+        if (m_microCam1Live.thrd || m_microCam2Live.thrd) onToggleLiveDetection();
         m_microCam1Op.toggleCamera();
         m_microCam2Op.toggleCamera();
-        {
-            QMutexLocker locker(&m_frameMutex);
-            m_latestMicroCam1Image = QImage();
-            m_latestMicroCam2Image = QImage();
-        }
+        m_microCam1PixmapItem->setPixmap(QPixmap());
+        m_microCam2PixmapItem->setPixmap(QPixmap());
         m_microCam1Op.cameraBtn->setText("Start Duo Cam");
         m_microCam1View->resetTransform();
         m_microCam2View->resetTransform();
@@ -576,13 +615,14 @@ void MainWindow::onStartDuocam() {
     }
 
     m_microCam1Op.thrd = new QThread(this);
-    m_microCam1Op.camWorker = new CameraWorker(1, 1, 1280, 720, 20);
+    m_microCam1Op.camWorker = new CameraWorker(replaySourceConfig().enabled ? IMG : 1, 1, 1280, 720, 20);
     m_microCam1Op.camWorker->moveToThread(m_microCam1Op.thrd);
+    m_microCam1Op.frames = std::make_shared<TripleFrameBuffer>();
+    m_microCam1Op.camWorker->setFrameBuffer(m_microCam1Op.frames);
 
     m_microCam1View->scale((float)m_microCam1View->width() / m_microCam1Op.camWorker->getFrameWidth(), (float)m_microCam1View->height() / m_microCam1Op.camWorker->getFrameHeight());
 
     connect(m_microCam1Op.thrd, &QThread::started, m_microCam1Op.camWorker, &CameraWorker::process);
-    connect(m_microCam1Op.camWorker, &CameraWorker::frameReady, this, &MainWindow::updateFrame, Qt::QueuedConnection);
     connect(m_microCam1Op.thrd, &QThread::finished, m_microCam1Op.camWorker, &QObject::deleteLater);
 
     m_microCam1Op.thrd->start();
@@ -590,13 +630,14 @@ void MainWindow::onStartDuocam() {
 
 
     m_microCam2Op.thrd = new QThread(this);
-    m_microCam2Op.camWorker = new CameraWorker(3, 2, 1280, 720, 20);
+    m_microCam2Op.camWorker = new CameraWorker(replaySourceConfig().enabled ? IMG : 3, 2, 1280, 720, 20);
     m_microCam2Op.camWorker->moveToThread(m_microCam2Op.thrd);
+    m_microCam2Op.frames = std::make_shared<TripleFrameBuffer>();
+    m_microCam2Op.camWorker->setFrameBuffer(m_microCam2Op.frames);
 
 	m_microCam2View->scale((float)m_microCam2View->width() / m_microCam2Op.camWorker->getFrameWidth(), (float)m_microCam2View->height() / m_microCam2Op.camWorker->getFrameHeight());
 
     connect(m_microCam2Op.thrd, &QThread::started, m_microCam2Op.camWorker, &CameraWorker::process);
-    connect(m_microCam2Op.camWorker, &CameraWorker::frameReady, this, &MainWindow::updateFrame, Qt::QueuedConnection);
     connect(m_microCam2Op.thrd, &QThread::finished, m_microCam2Op.camWorker, &QObject::deleteLater);
 
     m_microCam2Op.thrd->start();
@@ -652,7 +693,7 @@ void MainWindow::onCaptureMacroImg() {
     
 }
 
-void MainWindow::inferenceResult(const cv::Mat& frame, const std::vector<cv::Rect>& boxCentroids) {
+void MainWindow::inferenceResult(const cv::Mat& frame, const DetectionResult& detections) {
 
     // TODO: decide how to handle the inference result - directly update here or pass to camera worker?
     //m_arducamOp.camWorker->clearCapturedFrame(); // remove the captured frame
@@ -663,28 +704,113 @@ void MainWindow::inferenceResult(const cv::Mat& frame, const std::vector<cv::Rec
     // updating the frame as above does not show the rendered img as thrd is is not running
     // might need to add wait method to CameraWorker to actually wait and stop can be used to exit thrd?
 
-    // save the output frame to a file
-    cv::imwrite("output.jpg", frame);
+    m_macroImgInference.busy = false;
+    qint64 timeToResult = m_macroImgInference.requestTimer.elapsed();
+    if (++m_macroImgInference.requestCount == 1)
+        LOG_INFO("[TIMER] time to result (first prediction): " << timeToResult << " ms");
+    else
+        LOG_INFO("[TIMER] time to result (prediction #" << m_macroImgInference.requestCount << "): " << timeToResult << " ms");
 
+    if (frame.empty()) {
+        LOG_WARNING("Inference returned no frame.");
+    }
+    else {
+        showMacroResult(frame, detections);
+    }
+
+    // the inference service stays up for the next request, only the camera is stopped.
+    // An image opened from disk may have been predicted with the camera off.
+    if (m_arducamOp.thrd) {
+        m_arducamOp.toggleCamera();
+        m_arducamOp.cameraBtn->setText("Restart Arducam");
+    }
+}
+
+void MainWindow::showMacroResult(const cv::Mat& frame, const DetectionResult& detections) {
     LOG_INFO("Showing inference result");
 
-    cv::Mat resized;
-    cv::resize(frame, resized, cv::Size(3840, 2160));
-    QImage qImage(resized.data, resized.cols, resized.rows, resized.step, QImage::Format_RGB888);
-    updateFrame(qImage.copy(), ARDUCAM);
-    // copy the boxCentroids to use them later to change the color of detected boxes once processed
-    m_macroImgPath.clear();
-    m_macroImgPath = boxCentroids;
+    // the frame is shown as captured, detections are drawn by the scene on top of it
+    cv::Mat shown = frame;
+    if (frame.cols != 3840 || frame.rows != 2160)
+        cv::resize(frame, shown, cv::Size(3840, 2160));
 
-    // Clean up inference worker and thread
-    m_macroImgInference.free();
-    m_arducamOp.toggleCamera();
-    m_arducamOp.cameraBtn->setText("Restart Arducam");
+    // the QImage only borrows the pixels for the pixmap conversion
+    QImage qImage(static_cast<const uchar*>(shown.data), shown.cols, shown.rows, shown.step, QImage::Format_RGB888);
+    m_arducamPixmapItem->setPixmap(QPixmap::fromImage(qImage));
+    m_arducamPixmapItem->setTransform(QTransform()); // full resolution, not a preview
+    setMacroOverlay(detections, static_cast<double>(shown.cols) / frame.cols);
 
-    if (m_macroImgInference.thrd) {
-        m_macroImgInference.thrd->quit();
-        m_macroImgInference.thrd->wait();
+    // copy the path to use it later to highlight the detected boxes as they are processed
+    m_macroImgPath = detections.path;
+}
+
+void MainWindow::setMacroOverlay(const DetectionResult& detections, double scale) {
+    clearMacroOverlay();
+
+    m_macroOverlay = new QGraphicsItemGroup();
+    m_macroOverlay->setZValue(1); // above the camera pixmap
+    m_macroOverlay->setScale(scale);
+
+    const QPen boxPen(Qt::black, 2);
+    for (size_t i = 0; i < detections.boxes.size(); ++i) {
+        const cv::Rect& box = detections.boxes[i];
+        QGraphicsRectItem* rect = new QGraphicsRectItem(box.x, box.y, box.width, box.height);
+        rect->setPen(boxPen);
+        m_macroOverlay->addToGroup(rect);
+
+        const int classId = detections.classIds[i];
+        QString name = classId >= 0 && classId < static_cast<int>(m_classNames.size())
+            ? QString::fromStdString(m_classNames[classId]) : QString::number(classId);
+        QGraphicsSimpleTextItem* label = new QGraphicsSimpleTextItem(name + " " + QString::number(detections.scores[i], 'f', 2));
+        label->setPos(box.x, box.y - label->boundingRect().height());
+        m_macroOverlay->addToGroup(label);
+    }
+
+    const QPen pathPen(Qt::red, 2);
+    for (size_t i = 0; i + 1 < detections.path.size(); ++i) {
+        const cv::Rect& from = detections.path[i];
+        const cv::Rect& to = detections.path[i + 1];
+        QGraphicsLineItem* line = new QGraphicsLineItem(from.x + from.width / 2.0, from.y + from.height / 2.0,
+            to.x + to.width / 2.0, to.y + to.height / 2.0);
+        line->setPen(pathPen);
+        m_macroOverlay->addToGroup(line);
+    }
+
+    m_macroHighlight = new QGraphicsRectItem();
+    m_macroHighlight->setPen(QPen(Qt::green, 4));
+    m_macroHighlight->setVisible(false);
+    m_macroOverlay->addToGroup(m_macroHighlight);
+
+    m_arducamScene->addItem(m_macroOverlay);
+}
+
+void MainWindow::clearMacroOverlay() {
+    // the group owns its items
+    delete m_macroOverlay;
+    m_macroOverlay = nullptr;
+    m_macroHighlight = nullptr;
+}
+
+// Both cuts go to the inference worker, which re-filters the last prediction without running the model
+void MainWindow::onThresholdsEdited() {
+    bool confidenceOk = false, iouOk = false;
+    float confidence = m_confidenceEdit->text().toFloat(&confidenceOk);
+    float iou = m_iouEdit->text().toFloat(&iouOk);
+    if (!confidenceOk || !iouOk || confidence < 0.0f || confidence > 1.0f || iou < 0.0f || iou > 1.0f) {
+        LOG_WARNING("Invalid thresholds '" << m_confidenceEdit->text().toStdString() << "' / '"
+            << m_iouEdit->text().toStdString() << "', expected values in [0, 1]");
+        return;
     }
+    if (confidence == m_confidenceThreshold && iou == m_iouThreshold) return;
+
+    m_confidenceThreshold = confidence;
+    m_iouThreshold = iou;
+    emit thresholdsChanged(confidence, iou);
+}
+
+void MainWindow::onDetectionsRefiltered(const cv::Mat& frame, const DetectionResult& detections) {
+    LOG_INFO("Re-filtered macro prediction, " << detections.path.size() << " detections on the path");
+    showMacroResult(frame, detections);
 }
 
 
@@ -716,8 +842,61 @@ void MainWindow::setupTransformationMatrix() {
 
 
 
+// Tiling used for the next macro prediction, falls back to the defaults on malformed input.
+// "native" or "native:<size>" cuts unscaled tiles of that size instead of a cols x rows grid.
+// A "+cascade" suffix runs a coarse whole-frame pass first and only the tiles around its candidates.
+TileGridConfig MainWindow::readTileGridConfig() {
+    TileGridConfig config;
+
+    QString grid = m_tileGridEdit->text().trimmed().toLower();
+    const QString cascadeSuffix = "+cascade";
+    if (grid.endsWith(cascadeSuffix)) {
+        config.cascade = true;
+        grid = grid.left(grid.size() - cascadeSuffix.size()).trimmed();
+    }
+    // in native mode the grid follows from the image and tile size, only the tile size is read
+    if (grid.startsWith("native")) {
+        config.nativeResolution = true;
+        QStringList parts = grid.split(':');
+        if (parts.size() > 1) {
+            bool sizeOk = false;
+            int size = parts.value(1).trimmed().toInt(&sizeOk);
+            if (sizeOk && size >= 32)
+                config.nativeTileSize = size;
+            else
+                LOG_WARNING("Invalid native tile size '" << parts.value(1).toStdString() << "', using " << config.nativeTileSize);
+        }
+    }
+    else {
+        QStringList dims = grid.split('x');
+        bool colsOk = false, rowsOk = false;
+        int cols = dims.value(0).trimmed().toInt(&colsOk);
+        int rows = dims.size() > 1 ? dims.value(1).trimmed().toInt(&rowsOk) : cols;
+        if (dims.size() == 1) rowsOk = colsOk;
+
+        if (colsOk && rowsOk && cols > 0 && rows > 0) {
+            config.cols = cols;
+            config.rows = rows;
+        }
+        else {
+            LOG_WARNING("Invalid tile grid '" << m_tileGridEdit->text().toStdString() << "', using " << config.cols << "x" << config.rows);
+        }
+    }
+
+    bool overlapOk = false;
+    float overlap = m_tileOverlapEdit->text().toFloat(&overlapOk);
+    if (overlapOk && overlap >= 0.0f && overlap < 1.0f) {
+        config.overlap = overlap;
+    }
+    else {
+        LOG_WARNING("Invalid tile overlap '" << m_tileOverlapEdit->text().toStdString() << "', using " << config.overlap);
+    }
+
+    return config;
+}
+
 void MainWindow::onPredictMacroImg() {
-    if (!m_arducamOp.thrd || m_macroImgInference.thrd) {
+    if (!m_arducamOp.thrd || m_macroImgInference.busy) {
 		LOG_WARNING("Arducam thread is not running or inference is already in progress.");
         return;
     }
@@ -727,38 +906,162 @@ void MainWindow::onPredictMacroImg() {
         return;
     }
 
-	std::string modelPath = "deps/models/yolov11n_trainedv1.onnx";
-    if (!std::filesystem::exists(modelPath)) {
-		    LOG_CRITICAL("Model file does not exist: " << modelPath);
-        return;
-	}
+    if (!m_macroImgInference.ready) {
+        LOG_WARNING("Inference service is still loading the model. Request will run once it is ready.");
+    }
 
     m_arducamOp.camWorker->stop();
     
     {
 		LOG_INFO("Starting inference on captured macro image...");
 
-        m_macroImgInference.thrd = new QThread(this);
+        // requests are queued on the inference thread and run on the already warm session
+        m_macroImgInference.busy = true;
+        m_macroImgInference.requestTimer.start();
+        emit macroPredictionRequested(m_currentMacroImg, readTileGridConfig());
+    }
+    //m_arducamOp.camWorker->start(); // show the updated captured frame...
 
+}
 
-        m_macroImgInference.infWorker = new InferenceWorker(m_currentMacroImg.cols, m_currentMacroImg.rows, m_currentMacroImg);
-        m_macroImgInference.infWorker->moveToThread(m_macroImgInference.thrd);
+void MainWindow::onOpenMacroImg() {
+    if (m_macroImgInference.busy) {
+        LOG_WARNING("Inference is already in progress.");
+        return;
+    }
 
-        connect(m_macroImgInference.thrd, &QThread::started, m_macroImgInference.infWorker, &InferenceWorker::predict);
-        connect(m_macroImgInference.infWorker, &InferenceWorker::frameProcessed, this, &MainWindow::inferenceResult);
-        connect(m_macroImgInference.thrd, &QThread::finished, m_macroImgInference.infWorker, &QObject::deleteLater);
+    const QString folderPath = QDir(QCoreApplication::applicationDirPath()).filePath("macro_img");
+    const QString filePath = QFileDialog::getOpenFileName(this, "Open Macro Img", folderPath, "Images (*.png)");
+    if (filePath.isEmpty()) return;
 
-        m_macroImgInference.thrd->start();
+    // read back as saved, so the pixels and with them the detection cache key match the capture
+    cv::Mat image = cv::imread(filePath.toStdString(), cv::IMREAD_UNCHANGED);
+    if (image.empty()) {
+        LOG_WARNING("Could not read macro image: " << filePath.toStdString());
+        return;
     }
-    //m_arducamOp.camWorker->start(); // show the updated captured frame...
+    m_currentMacroImg = image;
+    LOG_INFO("Macro image opened: " << filePath.toStdString());
 
+    if (m_arducamOp.thrd) m_arducamOp.camWorker->stop();
+
+    // goes through the prediction path: an image predicted before comes back from its cache sidecar
+    // without running the model, anything else is predicted as usual
+    m_macroImgInference.busy = true;
+    m_macroImgInference.requestTimer.start();
+    emit macroPredictionRequested(m_currentMacroImg, readTileGridConfig());
 }
 
+void MainWindow::setupInferenceService() {
+    m_macroImgInference.thrd = new QThread(this);
+    m_macroImgInference.infWorker = new InferenceWorker();
+    // result sidecars live next to the saved macro images
+    m_macroImgInference.infWorker->setDetectionCacheDir(
+        QDir(QCoreApplication::applicationDirPath()).filePath("macro_img").toStdString());
+    // detections come back as data and are drawn as scene items, the frame itself is never touched
+    m_macroImgInference.infWorker->setDrawResults(false);
+    m_classNames = m_macroImgInference.infWorker->classNames();
+    m_macroImgInference.infWorker->moveToThread(m_macroImgInference.thrd);
+
+    connect(m_macroImgInference.thrd, &QThread::started, m_macroImgInference.infWorker, &InferenceWorker::initialize);
+    connect(m_macroImgInference.infWorker, &InferenceWorker::serviceReady, this, &MainWindow::onInferenceServiceReady);
+    connect(this, &MainWindow::macroPredictionRequested, m_macroImgInference.infWorker, &InferenceWorker::predict);
+    connect(m_macroImgInference.infWorker, &InferenceWorker::frameProcessed, this, &MainWindow::inferenceResult);
+    connect(this, &MainWindow::thresholdsChanged, m_macroImgInference.infWorker, &InferenceWorker::setThresholds);
+    connect(m_macroImgInference.infWorker, &InferenceWorker::detectionsRefiltered, this, &MainWindow::onDetectionsRefiltered);
+    connect(m_macroImgInference.thrd, &QThread::finished, m_macroImgInference.infWorker, &QObject::deleteLater);
+
+    m_macroImgInference.thrd->start();
+}
+
+void MainWindow::onInferenceServiceReady(bool ok) {
+    m_macroImgInference.ready = ok;
+    if (!ok) {
+        LOG_CRITICAL("Inference service failed to load the model, macro prediction is unavailable.");
+    }
+}
 
 
 
 //----------------------------------------------------------------------------------------------------------------
 
+void MainWindow::onToggleLiveDetection() {
+    if (m_microCam1Live.thrd || m_microCam2Live.thrd) {
+        LOG_INFO("stopping live detection");
+        stopLiveDetection(m_microCam1Live, m_microCam1Op);
+        stopLiveDetection(m_microCam2Live, m_microCam2Op);
+        m_microCam1LiveFPS->setText("microCam1 det FPS - 0");
+        m_microCam2LiveFPS->setText("microCam2 det FPS - 0");
+        m_liveDetectBtn->setText("Start Live Detection");
+        return;
+    }
+
+    if (!m_microCam1Op.thrd && !m_microCam2Op.thrd) {
+        LOG_WARNING("Duo cams are not running. Start them before live detection.");
+        return;
+    }
+
+    LOG_INFO("starting live detection");
+    if (m_microCam1Op.thrd) startLiveDetection(m_microCam1Live, m_microCam1Op, MICROCAM1);
+    if (m_microCam2Op.thrd) startLiveDetection(m_microCam2Live, m_microCam2Op, MICROCAM2);
+    m_liveDetectBtn->setText("Stop Live Detection");
+}
+
+void MainWindow::startLiveDetection(liveDetectionOp& live, cameraOp& camera, int cameraType) {
+    // micro cam frames go to the model unscaled, in 640 px tiles (3x2 at 1280x720)
+    TileGridConfig liveTiling;
+    liveTiling.nativeResolution = true;
+
+    live.slot = std::make_shared<LatestFrameSlot>();
+    live.thrd = new QThread(this);
+    live.infWorker = new InferenceWorker();
+    live.infWorker->setThreadRole(ThreadRole::LiveInference, cameraType == MICROCAM1 ? 0 : 1);
+    live.infWorker->setLiveSource(live.slot, cameraType, liveTiling);
+    live.infWorker->moveToThread(live.thrd);
+
+    // both run on the worker thread in connection order: load the model, then detect until the slot closes
+    connect(live.thrd, &QThread::started, live.infWorker, &InferenceWorker::initialize);
+    connect(live.thrd, &QThread::started, live.infWorker, &InferenceWorker::runLive);
+    connect(live.infWorker, &InferenceWorker::liveDetections, this, &MainWindow::onLiveDetections);
+    connect(live.thrd, &QThread::finished, live.infWorker, &QObject::deleteLater);
+
+    live.resultCount = 0;
+    live.latencySumMs = 0;
+    live.FPSTimer.start();
+    camera.camWorker->setLiveSlot(live.slot);
+    live.thrd->start();
+}
+
+void MainWindow::stopLiveDetection(liveDetectionOp& live, cameraOp& camera) {
+    if (!live.thrd) return;
+    if (camera.camWorker) camera.camWorker->setLiveSlot(nullptr);
+    live.free();
+    live.boxes.clear();
+}
+
+void MainWindow::onLiveDetections(int cameraType, const std::vector<cv::Rect>& boxes, qint64 capturedAtMs) {
+    liveDetectionOp& live = cameraType == MICROCAM1 ? m_microCam1Live : m_microCam2Live;
+    if (!live.thrd) return; // queued before live detection was stopped
+
+    // drawn over the next preview frame, ~one UI tick from now
+    live.boxes = boxes;
+    live.latencySumMs += steadyClockMs() - capturedAtMs;
+    live.resultCount++;
+
+    if (live.FPSTimer.elapsed() >= 1000) {
+        const double fps = live.resultCount * 1000.0 / live.FPSTimer.elapsed();
+        const qint64 latencyMs = live.latencySumMs / live.resultCount;
+        const QString name = cameraType == MICROCAM1 ? "microCam1" : "microCam2";
+        (cameraType == MICROCAM1 ? m_microCam1LiveFPS : m_microCam2LiveFPS)->setText(
+            QString("%1 det FPS - %2, %3 ms").arg(name).arg(fps, 0, 'f', 1).arg(latencyMs));
+        if (get_fpsDebug_flag())
+            LOG_INFO("[LIVE] " << name.toStdString() << ": " << fps << " detections/s, frame -> overlay " << latencyMs << " ms");
+        live.resultCount = 0;
+        live.latencySumMs = 0;
+        live.FPSTimer.restart();
+    }
+}
+
 void MainWindow::onCaptureMicroImg() {
     // ====== MicroCam1 ======
     if (!m_microCam1Op.thrd) {
@@ -844,6 +1147,7 @@ void MainWindow::onPredictMicroImg() {
     connect(m_traverser, &DetectionTraverser::traversalStarted, this, &MainWindow::onTraversalStarted);
     connect(m_traverser, &DetectionTraverser::waitingForUserAdjustment, this, &MainWindow::onWaitingForUser);
     connect(m_traverser, &DetectionTraverser::traversalFinished, this, &MainWindow::onTraversalFinished);
+    connect(m_traverser, &DetectionTraverser::updateProgress, this, &MainWindow::onTraversalProgress);
 
     // For cleanup
     connect(m_traverserThread, &QThread::finished, m_traverserThread, &QObject::deleteLater);
@@ -901,6 +1205,16 @@ void MainWindow::onTraversalFinished(const QString& message) {
     }
 
 	m_predictMicroImg->setEnabled(true);
+    if (m_macroHighlight) m_macroHighlight->setVisible(false);
+}
+
+// the box the stage is heading to is outlined in the overlay, no image is redrawn
+void MainWindow::onTraversalProgress(int current, int total) {
+    if (!m_macroHighlight || current < 1 || current > static_cast<int>(m_macroImgPath.size())) return;
+
+    const cv::Rect& target = m_macroImgPath[current - 1];
+    m_macroHighlight->setRect(target.x, target.y, target.width, target.height);
+    m_macroHighlight->setVisible(true);
 }
 
 void MainWindow::onAbortPathClicked() {
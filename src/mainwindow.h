@@ -14,6 +14,8 @@
 #include "inferenceworker.h"
 #include <QLineEdit>
 #include <QGraphicsPixmapItem>
+#include <QGraphicsItemGroup>
+#include <QGraphicsRectItem>
 #include "ZoomableGraphicsView.h"
 #include "XYZStage.h"
 #include "DetectionTraverser.h"
@@ -26,8 +28,13 @@ struct cameraOp
     QElapsedTimer FPSTimer;
     int frameCount;
     QPushButton* cameraBtn;
+    std::shared_ptr<TripleFrameBuffer> frames; // camera -> UI handoff, read by renderLatestFrame
+    qint64 latencySumMs = 0;                   // capture -> display of the frames shown this second
+    double previewScale = 0.0;                 // last preview scale sent to the worker
 
     void toggleCamera() {
+        frames.reset();
+        previewScale = 0.0;
         camWorker->stop();
         thrd->quit();
         thrd->wait();
@@ -37,10 +44,15 @@ struct cameraOp
     };
 };
 
+// persistent inference service, lives for the whole session
 struct inferenceOp
 {
-    QThread* thrd;
-    InferenceWorker* infWorker;
+    QThread* thrd = nullptr;
+    InferenceWorker* infWorker = nullptr;
+    bool ready = false;
+    bool busy = false;
+    int requestCount = 0;
+    QElapsedTimer requestTimer; // click -> result latency
 
     void free() {
         thrd->quit();
@@ -51,6 +63,28 @@ struct inferenceOp
     }
 };
 
+// live detection on one micro cam: a dedicated inference worker fed through the camera's latest-frame slot
+struct liveDetectionOp
+{
+    QThread* thrd = nullptr;
+    InferenceWorker* infWorker = nullptr;
+    std::shared_ptr<LatestFrameSlot> slot;
+    std::vector<cv::Rect> boxes; // latest result, drawn over every preview frame until the next one
+    QElapsedTimer FPSTimer;
+    int resultCount = 0;
+    qint64 latencySumMs = 0; // frame capture -> boxes on the preview
+
+    void free() {
+        slot->close(); // ends runLive, so the thread can quit
+        thrd->quit();
+        thrd->wait();
+        infWorker = nullptr;
+        thrd->deleteLater();
+        thrd = nullptr;
+        slot.reset();
+    }
+};
+
 class MainWindow : public QMainWindow {
     Q_OBJECT
 
@@ -68,19 +102,31 @@ public:
     QLabel* setupArducamUI();
     QLabel* setupDuocamUI();
 
-    void updateFrame(const QImage& img, int camType);
+    // newest frame of one camera onto its view, nothing to do when it has not delivered a new one
+    void updateFrame(cameraOp& camera, QGraphicsView* view, QGraphicsPixmapItem* item, const std::vector<cv::Rect>& liveBoxes,
+        const QString& name, QLabel* fpsLabel);
     void renderLatestFrame();
 
     void onStartArducam();
     void onCaptureMacroImg();
-    void inferenceResult(const cv::Mat& frame, const std::vector<cv::Rect>& boxCentroids);
+    void setupInferenceService();
+    void onInferenceServiceReady(bool ok);
+    void inferenceResult(const cv::Mat& frame, const DetectionResult& detections);
+    void onThresholdsEdited();
+    void onDetectionsRefiltered(const cv::Mat& frame, const DetectionResult& detections);
     void onPredictMacroImg();
+    // reopens a saved macro_img/*.png, its cached detections are shown without running the model
+    void onOpenMacroImg();
 
 
     void onGoToPosition1();
     void onStartDuocam();
     void onCaptureMicroImg();
     void onPredictMicroImg();
+    void onToggleLiveDetection();
+    void startLiveDetection(liveDetectionOp& live, cameraOp& camera, int cameraType);
+    void stopLiveDetection(liveDetectionOp& live, cameraOp& camera);
+    void onLiveDetections(int cameraType, const std::vector<cv::Rect>& boxes, qint64 capturedAtMs);
 
     void onLeftFastClicked();
     void onLeftSlowClicked();
@@ -100,6 +146,7 @@ public:
     void onSlant4Clicked();
     void updatePositionDisplay();
     void setupTransformationMatrix();
+    TileGridConfig readTileGridConfig();
     void onAbortPathClicked();
 	void onResumePathClicked();
 	void setMovementControlsEnabled(bool enabled);
@@ -108,11 +155,20 @@ public:
     void onWaitingForUser();
     void onConfirmAdjustmentClicked();
     void onTraversalFinished(const QString& message);
+    void onTraversalProgress(int current, int total);
+
+signals:
+    void macroPredictionRequested(const cv::Mat& frame, const TileGridConfig& config);
+    void thresholdsChanged(float confidence, float iou);
 
 private:
     // Transformation methods
     cv::Mat calculateTransformationMatrix(const std::vector<cv::Point2f>& imagePoints,
         const std::vector<cv::Point2f>& realPoints);
+    void showMacroResult(const cv::Mat& frame, const DetectionResult& detections);
+    // boxes, labels and path as scene items over the arducam pixmap, scale maps frame to pixmap pixels
+    void setMacroOverlay(const DetectionResult& detections, double scale);
+    void clearMacroOverlay();
 
     // private class members
     cv::Mat m_transformMatrix;
@@ -128,6 +184,12 @@ private:
     QLineEdit* m_y1;
     QLineEdit* m_z1;
     QLineEdit* m_stepEdit;
+    QLineEdit* m_tileGridEdit;
+    QLineEdit* m_tileOverlapEdit;
+    QLineEdit* m_confidenceEdit;
+    QLineEdit* m_iouEdit;
+    float m_confidenceThreshold = CONFIDENCE_THRESHOLD; // last cut sent to the inference worker
+    float m_iouThreshold = OVERLAP_THRESHOLD;
     bool abort = false;
 	bool pause = false;
 
@@ -139,14 +201,15 @@ private:
     QLabel* m_arducamFPS = nullptr;
     cameraOp m_arducamOp;
     inferenceOp m_macroImgInference;
-	QImage m_latestArducamImage;
 	cv::Mat m_currentMacroImg;
 	std::vector<cv::Rect> m_macroImgPath;
+    std::vector<std::string> m_classNames;
+    QGraphicsItemGroup* m_macroOverlay = nullptr;   // owned by m_arducamScene while shown
+    QGraphicsRectItem* m_macroHighlight = nullptr;  // current traversal target, part of m_macroOverlay
 
     ZoomableGraphicsView* m_microCam1View = nullptr;
     QGraphicsScene* m_microCam1Scene = nullptr;
     QGraphicsPixmapItem* m_microCam1PixmapItem = nullptr;
-	QImage m_latestMicroCam1Image;
     cv::Mat m_currentMicroImg1;
     QLabel* m_microCam1FPS = nullptr;
     cameraOp m_microCam1Op;
@@ -154,12 +217,16 @@ private:
     ZoomableGraphicsView* m_microCam2View = nullptr;
     QGraphicsScene* m_microCam2Scene = nullptr;
     QGraphicsPixmapItem* m_microCam2PixmapItem = nullptr;
-    QImage m_latestMicroCam2Image;
     cv::Mat m_currentMicroImg2;
     QLabel* m_microCam2FPS = nullptr;
     cameraOp m_microCam2Op;
 
-	QMutex m_frameMutex;
+    liveDetectionOp m_microCam1Live;
+    liveDetectionOp m_microCam2Live;
+    QLabel* m_microCam1LiveFPS = nullptr;
+    QLabel* m_microCam2LiveFPS = nullptr;
+    QPushButton* m_liveDetectBtn = nullptr;
+
 	QLabel* m_uiFPS = nullptr;
     QElapsedTimer m_UITimer;
     int m_uiFrameCount;
@@ -0,0 +1,116 @@
+#include "modelcache.h"
+
+#include <onnxruntime_cxx_api.h>
+#include <opencv2/core.hpp>
+
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// FNV-1a over the file contents, a renamed or touched file with the same bytes keeps its cache
+bool modelFileHash(const std::string& path, uint64_t& hash) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return false;
+
+    hash = 1469598103934665603ull;
+    std::vector<char> chunk(1 << 16);
+    while (file.read(chunk.data(), chunk.size()) || file.gcount() > 0) {
+        for (std::streamsize i = 0; i < file.gcount(); ++i) {
+            hash ^= static_cast<unsigned char>(chunk[i]);
+            hash *= 1099511628211ull;
+        }
+    }
+    return true;
+}
+
+namespace {
+
+// instruction sets ORT picks kernels by, as a bit mask
+unsigned cpuFeatureMask() {
+    const int features[] = { CV_CPU_SSE4_1, CV_CPU_AVX, CV_CPU_FMA3, CV_CPU_AVX2, CV_CPU_AVX_512F, CV_CPU_AVX_512BW, CV_CPU_AVX_512VNNI };
+    unsigned mask = 0;
+    for (size_t i = 0; i < sizeof(features) / sizeof(features[0]); ++i)
+        if (cv::checkHardwareSupport(features[i])) mask |= 1u << i;
+    return mask;
+}
+
+} // namespace
+
+
+std::string optimizedModelCachePath(const std::string& modelPath, uint64_t modelHash, const std::string& cacheDir) {
+    char key[64];
+    std::snprintf(key, sizeof(key), "_%016llx_cpu%02x", static_cast<unsigned long long>(modelHash), cpuFeatureMask());
+    const std::string name = std::filesystem::path(modelPath).stem().string() + key + "_ort" + Ort::GetVersionString() + ".ort";
+    return (std::filesystem::path(cacheDir) / name).string();
+}
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::string& path) {
+    m_file = CreateFileW(std::filesystem::path(path).c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (m_file == INVALID_HANDLE_VALUE) {
+        m_file = nullptr;
+        throw std::runtime_error("cannot open " + path);
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(m_file, &size) || size.QuadPart == 0) {
+        CloseHandle(m_file);
+        throw std::runtime_error("cannot map empty file " + path);
+    }
+    m_size = static_cast<size_t>(size.QuadPart);
+
+    m_mapping = CreateFileMappingW(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    m_data = m_mapping ? MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (!m_data) {
+        if (m_mapping) CloseHandle(m_mapping);
+        CloseHandle(m_file);
+        throw std::runtime_error("cannot map " + path);
+    }
+}
+
+MappedFile::~MappedFile() {
+    UnmapViewOfFile(m_data);
+    CloseHandle(m_mapping);
+    CloseHandle(m_file);
+}
+
+#else
+
+MappedFile::MappedFile(const std::string& path) {
+    m_fd = open(path.c_str(), O_RDONLY);
+    if (m_fd < 0) throw std::runtime_error("cannot open " + path);
+
+    struct stat info;
+    if (fstat(m_fd, &info) != 0 || info.st_size == 0) {
+        close(m_fd);
+        throw std::runtime_error("cannot map empty file " + path);
+    }
+    m_size = static_cast<size_t>(info.st_size);
+
+    m_data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, m_fd, 0);
+    if (m_data == MAP_FAILED) {
+        close(m_fd);
+        throw std::runtime_error("cannot map " + path);
+    }
+}
+
+MappedFile::~MappedFile() {
+    munmap(m_data, m_size);
+    close(m_fd);
+}
+
+#endif
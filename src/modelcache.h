@@ -0,0 +1,41 @@
+#ifndef MODELCACHE_H
+#define MODELCACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// 64-bit hash of the model file's bytes, identifies a model independent of its path
+bool modelFileHash(const std::string& path, uint64_t& hash);
+
+// Where the ORT-format copy of an optimized model lives. The name carries a hash of the model file,
+// the ORT version and the CPU features, so a new model, a runtime update or another machine never
+// picks up a graph optimized for something else. modelHash is modelFileHash of modelPath.
+std::string optimizedModelCachePath(const std::string& modelPath, uint64_t modelHash,
+    const std::string& cacheDir = "deps/models/ort_cache");
+
+// Read-only memory mapping of a whole file, throws std::runtime_error when it can't be mapped.
+// ORT reads the cached model and its initializers straight from the mapping, so it has to outlive the session.
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const void* data() const { return m_data; }
+    size_t size() const { return m_size; }
+
+private:
+    void* m_data = nullptr;
+    size_t m_size = 0;
+#ifdef _WIN32
+    void* m_file = nullptr;    // HANDLE
+    void* m_mapping = nullptr; // HANDLE
+#else
+    int m_fd = -1;
+#endif
+};
+
+#endif // MODELCACHE_H
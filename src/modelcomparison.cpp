@@ -0,0 +1,138 @@
+#include "modelcomparison.h"
+#include "inferenceworker.h"
+#include "utils.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+
+namespace {
+
+const float MATCH_IOU = 0.5f;
+
+float boxIoU(const cv::Rect& a, const cv::Rect& b) {
+    double inter = (a & b).area();
+    if (inter <= 0) return 0.0f;
+    return static_cast<float>(inter / (a.area() + b.area() - inter));
+}
+
+// Greedy one-to-one matching, best overlapping pairs first. A pair needs the same class, a box INT8
+// calls clump where FP32 saw ce is a disagreement. Returns the number of matched pairs.
+int matchDetections(const DetectionResult& a, const DetectionResult& b, double& iouSum) {
+    struct Pair { float iou; int i, j; };
+    std::vector<Pair> pairs;
+    for (int i = 0; i < static_cast<int>(a.boxes.size()); ++i)
+        for (int j = 0; j < static_cast<int>(b.boxes.size()); ++j) {
+            if (a.classIds[i] != b.classIds[j]) continue;
+            float iou = boxIoU(a.boxes[i], b.boxes[j]);
+            if (iou >= MATCH_IOU) pairs.push_back({ iou, i, j });
+        }
+    std::sort(pairs.begin(), pairs.end(), [](const Pair& x, const Pair& y) { return x.iou > y.iou; });
+
+    std::vector<char> usedA(a.boxes.size(), 0), usedB(b.boxes.size(), 0);
+    int matched = 0;
+    for (const Pair& p : pairs) {
+        if (usedA[p.i] || usedB[p.j]) continue;
+        usedA[p.i] = usedB[p.j] = 1;
+        iouSum += p.iou;
+        ++matched;
+    }
+    return matched;
+}
+
+std::vector<std::filesystem::path> listImages(const std::string& folder) {
+    std::vector<std::filesystem::path> images;
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(folder, ec)) {
+        if (!entry.is_regular_file()) continue;
+        std::string ext = entry.path().extension().string();
+        std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        if (ext == ".png" || ext == ".jpg" || ext == ".jpeg" || ext == ".bmp")
+            images.push_back(entry.path());
+    }
+    std::sort(images.begin(), images.end());
+    return images;
+}
+
+} // namespace
+
+
+int compareModels(const std::string& imageFolder, const TileGridConfig& config) {
+    std::vector<std::filesystem::path> images = listImages(imageFolder);
+    if (images.empty()) {
+        LOG_WARNING("[COMPARE] No images found in " << imageFolder);
+        return 1;
+    }
+
+    InferenceWorker fp32;
+    InferenceWorker int8;
+    fp32.setModelPrecision(ModelPrecision::FP32);
+    int8.setModelPrecision(ModelPrecision::INT8);
+    fp32.setDrawResults(false);
+    int8.setDrawResults(false);
+
+    // initialize() falls back to FP32 when the INT8 file is missing, that would compare FP32 with itself
+    fp32.initialize();
+    int8.initialize();
+    if (!fp32.isReady() || !int8.isReady() || int8.modelPrecision() != ModelPrecision::INT8) {
+        LOG_CRITICAL("[COMPARE] Could not load both models (INT8 expected at "
+            << InferenceWorker::modelPathFor(ModelPrecision::INT8) << ")");
+        return 1;
+    }
+
+    double fp32TotalMs = 0.0, int8TotalMs = 0.0, iouSum = 0.0, countDeltaSum = 0.0;
+    int fp32Boxes = 0, int8Boxes = 0, matched = 0, compared = 0;
+
+    for (const std::filesystem::path& path : images) {
+        cv::Mat image = cv::imread(path.string());
+        if (image.empty()) {
+            LOG_WARNING("[COMPARE] Could not read " << path.string());
+            continue;
+        }
+
+        // drawing is off, both models read the same undrawn image; the result is copied before the next run
+        auto timeDetect = [&](InferenceWorker& worker, double& ms) {
+            auto start = std::chrono::high_resolution_clock::now();
+            DetectionResult result = worker.runDetection(image, config);
+            auto end = std::chrono::high_resolution_clock::now();
+            ms = std::chrono::duration<double, std::milli>(end - start).count();
+            return result;
+        };
+
+        double fp32Ms = 0.0, int8Ms = 0.0;
+        const DetectionResult fp32Result = timeDetect(fp32, fp32Ms);
+        const DetectionResult int8Result = timeDetect(int8, int8Ms);
+        const int fp32Count = static_cast<int>(fp32Result.boxes.size());
+        const int int8Count = static_cast<int>(int8Result.boxes.size());
+        int imageMatched = matchDetections(fp32Result, int8Result, iouSum);
+
+        LOG_INFO("[COMPARE] " << path.filename().string() << ": FP32 " << fp32Ms << " ms / " << fp32Count
+            << " boxes, INT8 " << int8Ms << " ms / " << int8Count << " boxes, matched " << imageMatched
+            << ", count delta " << int8Count - fp32Count);
+
+        fp32TotalMs += fp32Ms;
+        int8TotalMs += int8Ms;
+        fp32Boxes += fp32Count;
+        int8Boxes += int8Count;
+        matched += imageMatched;
+        countDeltaSum += std::abs(int8Count - fp32Count);
+        ++compared;
+    }
+
+    if (compared == 0) {
+        LOG_WARNING("[COMPARE] None of the images in " << imageFolder << " could be read");
+        return 1;
+    }
+
+    // F1-style agreement: 1.0 when every box has a partner in the other model's output
+    const double agreement = fp32Boxes + int8Boxes > 0 ? 2.0 * matched / (fp32Boxes + int8Boxes) : 1.0;
+    LOG_INFO("[COMPARE] " << compared << " images: FP32 " << fp32TotalMs / compared << " ms, INT8 "
+        << int8TotalMs / compared << " ms per image (speedup " << fp32TotalMs / std::max(int8TotalMs, 1e-9) << "x)");
+    LOG_INFO("[COMPARE] boxes FP32 " << fp32Boxes << ", INT8 " << int8Boxes << ", matched " << matched
+        << " (FP32 only " << fp32Boxes - matched << ", INT8 only " << int8Boxes - matched << "), agreement "
+        << agreement << ", mean matched IoU " << (matched ? iouSum / matched : 0.0) << ", mean |count delta| "
+        << countDeltaSum / compared);
+
+    return 0;
+}
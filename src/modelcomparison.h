@@ -0,0 +1,14 @@
+#ifndef MODELCOMPARISON_H
+#define MODELCOMPARISON_H
+
+#include <string>
+
+#include "tiling.h"
+
+// Runs the FP32 and INT8 models over every image in imageFolder through the full tiled pipeline
+// and logs per-image and overall latency and detection agreement (one-to-one IoU matches of the
+// same class and count deltas). Returns a process exit code, 0 when both models loaded and images were found.
+// Started with: Injector_app.exe --compare-models <folder>
+int compareModels(const std::string& imageFolder, const TileGridConfig& config = TileGridConfig());
+
+#endif // MODELCOMPARISON_H
@@ -0,0 +1,256 @@
+#include "nms.h"
+#include "utils.h"
+
+#include <opencv2/dnn.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <random>
+
+namespace {
+
+// Same overlap as NMSBoxes, so hard NMS makes the same decisions at the threshold
+inline float rectOverlap(const cv::Rect& a, const cv::Rect& b) {
+    double inter = (a & b).area();
+    if (inter <= 0) return 0.0f;
+    return static_cast<float>(inter / (a.area() + b.area() - inter));
+}
+
+// Uniform grid over the candidates' bounding rect. A box is listed in every cell it touches, so two
+// intersecting boxes always share at least one cell.
+struct BucketGrid {
+    int originX = 0, originY = 0;
+    int cellSize = 1;
+    int cols = 0, rows = 0;
+    std::vector<std::vector<int>> cells;
+
+    void reset(const cv::Rect& bounds, int size) {
+        // cap the cell count so a few huge outliers can't blow the grid up
+        const int maxCells = 4096;
+        cellSize = std::max(size, 1);
+        while (((bounds.width / cellSize) + 1) * ((bounds.height / cellSize) + 1) > maxCells)
+            cellSize *= 2;
+
+        originX = bounds.x;
+        originY = bounds.y;
+        cols = bounds.width / cellSize + 1;
+        rows = bounds.height / cellSize + 1;
+
+        // clear but keep each bucket's capacity between calls
+        if (static_cast<int>(cells.size()) < cols * rows)
+            cells.resize(cols * rows);
+        for (int i = 0; i < cols * rows; ++i)
+            cells[i].clear();
+    }
+
+    template <typename Fn>
+    void forEachCell(const cv::Rect& r, Fn&& fn) {
+        int c0 = std::clamp((r.x - originX) / cellSize, 0, cols - 1);
+        int r0 = std::clamp((r.y - originY) / cellSize, 0, rows - 1);
+        int c1 = std::clamp((r.x + std::max(r.width - 1, 0) - originX) / cellSize, 0, cols - 1);
+        int r1 = std::clamp((r.y + std::max(r.height - 1, 0) - originY) / cellSize, 0, rows - 1);
+        for (int y = r0; y <= r1; ++y)
+            for (int x = c0; x <= c1; ++x)
+                if (!fn(cells[y * cols + x])) return;
+    }
+
+    void insert(const cv::Rect& r, int idx) {
+        forEachCell(r, [idx](std::vector<int>& cell) { cell.push_back(idx); return true; });
+    }
+};
+
+// Scratch space reused between calls on the same thread
+struct NmsWorkspace {
+    std::vector<int> order;
+    std::vector<int> visited; // per-candidate stamp, skips boxes listed in several cells
+    std::vector<char> done;
+    std::vector<std::pair<float, int>> heap;
+    BucketGrid grid;
+    int stamp = 0;
+
+    void prepare(size_t n) {
+        if (visited.size() < n) {
+            visited.assign(n, 0);
+            done.resize(n);
+            stamp = 0;
+        }
+    }
+};
+
+void buildGrid(NmsWorkspace& ws, const std::vector<cv::Rect>& boxes) {
+    cv::Rect bounds;
+    double sumSize = 0.0;
+    for (int idx : ws.order) {
+        bounds = bounds.empty() ? boxes[idx] : (bounds | boxes[idx]);
+        sumSize += std::max(boxes[idx].width, boxes[idx].height);
+    }
+
+    // about one box per cell: a box touches at most 4 cells
+    int cellSize = static_cast<int>(sumSize / std::max<size_t>(ws.order.size(), 1));
+    ws.grid.reset(bounds, std::max(cellSize, 8));
+}
+
+void hardNms(NmsWorkspace& ws, const std::vector<cv::Rect>& boxes, const std::vector<int>& classIds,
+    const NmsConfig& config, std::vector<int>& keep) {
+    for (int idx : ws.order) {
+        const cv::Rect& box = boxes[idx];
+        const int stamp = ++ws.stamp;
+        bool suppressed = false;
+
+        ws.grid.forEachCell(box, [&](const std::vector<int>& cell) {
+            for (int k : cell) {
+                if (ws.visited[k] == stamp) continue;
+                ws.visited[k] = stamp;
+                if (config.classAware && classIds[k] != classIds[idx]) continue;
+                if (rectOverlap(box, boxes[k]) > config.iouThreshold) {
+                    suppressed = true;
+                    return false;
+                }
+            }
+            return true;
+        });
+
+        // only kept boxes go in the grid, they are all a later candidate has to beat
+        if (!suppressed) {
+            keep.push_back(idx);
+            ws.grid.insert(box, idx);
+        }
+    }
+}
+
+void softNms(NmsWorkspace& ws, const std::vector<cv::Rect>& boxes, std::vector<float>& scores,
+    const std::vector<int>& classIds, const NmsConfig& config, std::vector<int>& keep) {
+    // every live candidate is in the grid, picking a box decays its live neighbours. Decayed boxes are
+    // pushed again with their new score, stale heap entries are skipped when popped.
+    ws.heap.clear();
+    for (int idx : ws.order) {
+        ws.done[idx] = 0;
+        ws.heap.emplace_back(scores[idx], idx);
+        ws.grid.insert(boxes[idx], idx);
+    }
+    std::make_heap(ws.heap.begin(), ws.heap.end());
+
+    while (!ws.heap.empty()) {
+        std::pop_heap(ws.heap.begin(), ws.heap.end());
+        auto [score, idx] = ws.heap.back();
+        ws.heap.pop_back();
+        if (ws.done[idx] || score != scores[idx]) continue;
+
+        ws.done[idx] = 1;
+        keep.push_back(idx);
+
+        const cv::Rect& box = boxes[idx];
+        const int stamp = ++ws.stamp;
+        ws.grid.forEachCell(box, [&](const std::vector<int>& cell) {
+            for (int k : cell) {
+                if (ws.done[k] || ws.visited[k] == stamp) continue;
+                ws.visited[k] = stamp;
+                if (config.classAware && classIds[k] != classIds[idx]) continue;
+
+                float overlap = rectOverlap(box, boxes[k]);
+                if (overlap <= 0.0f) continue;
+
+                scores[k] *= std::exp(-(overlap * overlap) / config.softSigma);
+                if (scores[k] > config.scoreThreshold) {
+                    ws.heap.emplace_back(scores[k], k);
+                    std::push_heap(ws.heap.begin(), ws.heap.end());
+                } else {
+                    ws.done[k] = 1;
+                }
+            }
+            return true;
+        });
+    }
+}
+
+} // namespace
+
+
+void nonMaxSuppression(const std::vector<cv::Rect>& boxes, std::vector<float>& scores, const std::vector<int>& classIds,
+    const NmsConfig& config, std::vector<int>& keep) {
+    thread_local NmsWorkspace ws;
+    keep.clear();
+    ws.order.clear();
+    ws.prepare(boxes.size());
+
+    for (int i = 0; i < static_cast<int>(boxes.size()); ++i)
+        if (scores[i] > config.scoreThreshold)
+            ws.order.push_back(i);
+    if (ws.order.empty()) return;
+
+    // best first, index breaks ties so the result matches a stable sort without its temp buffer
+    std::sort(ws.order.begin(), ws.order.end(), [&](int a, int b) {
+        return scores[a] > scores[b] || (scores[a] == scores[b] && a < b);
+    });
+
+    buildGrid(ws, boxes);
+    if (config.softNms)
+        softNms(ws, boxes, scores, classIds, config, keep);
+    else
+        hardNms(ws, boxes, classIds, config, keep);
+}
+
+void benchmarkNms(const cv::Size& frameSize, const NmsConfig& config, int iterations) {
+    if (frameSize.empty() || iterations <= 0) return;
+
+    for (int count : { 1000, 10000, 50000 }) {
+        // worms clumped around a few hundred spots, each seen by several overlapping candidates
+        std::mt19937 rng(count);
+        std::uniform_int_distribution<int> centerX(0, frameSize.width - 1), centerY(0, frameSize.height - 1);
+        std::normal_distribution<float> jitter(0.0f, 6.0f);
+        std::uniform_int_distribution<int> size(20, 60);
+        std::uniform_real_distribution<float> score(config.scoreThreshold, 1.0f);
+
+        std::vector<cv::Point> centers(std::max(count / 20, 1));
+        for (cv::Point& c : centers) c = cv::Point(centerX(rng), centerY(rng));
+
+        std::vector<cv::Rect> boxes(count);
+        std::vector<float> scores(count);
+        std::vector<int> classIds(count);
+        for (int i = 0; i < count; ++i) {
+            const cv::Point& c = centers[rng() % centers.size()];
+            int w = size(rng), h = size(rng);
+            boxes[i] = cv::Rect(c.x + static_cast<int>(jitter(rng)) - w / 2, c.y + static_cast<int>(jitter(rng)) - h / 2, w, h);
+            scores[i] = score(rng);
+            classIds[i] = rng() % 2;
+        }
+
+        auto timeRuns = [&](auto&& fn) {
+            auto start = std::chrono::high_resolution_clock::now();
+            for (int it = 0; it < iterations; ++it) fn();
+            auto end = std::chrono::high_resolution_clock::now();
+            return std::chrono::duration<double, std::milli>(end - start).count() / iterations;
+        };
+
+        std::vector<int> reference;
+        double referenceMs = timeRuns([&] {
+            cv::dnn::NMSBoxes(boxes, scores, config.scoreThreshold, config.iouThreshold, reference);
+        });
+
+        // class-agnostic hard NMS must keep exactly what NMSBoxes keeps
+        NmsConfig agnostic = config;
+        agnostic.classAware = false;
+        agnostic.softNms = false;
+        std::vector<int> agnosticKeep;
+        double agnosticMs = timeRuns([&] { nonMaxSuppression(boxes, scores, classIds, agnostic, agnosticKeep); });
+
+        // soft-NMS rewrites scores, so each run works on a fresh copy
+        std::vector<int> keep;
+        std::vector<float> working;
+        double configuredMs = timeRuns([&] {
+            working = scores;
+            nonMaxSuppression(boxes, working, classIds, config, keep);
+        });
+
+        std::vector<int> sortedReference = reference, sortedAgnostic = agnosticKeep;
+        std::sort(sortedReference.begin(), sortedReference.end());
+        std::sort(sortedAgnostic.begin(), sortedAgnostic.end());
+
+        LOG_INFO("[BENCH] NMS " << count << " candidates: NMSBoxes " << referenceMs << " ms (" << reference.size()
+            << " kept), bucketed " << agnosticMs << " ms (" << agnosticKeep.size() << " kept, "
+            << (sortedReference == sortedAgnostic ? "matches" : "DIFFERS") << "), configured ("
+            << (config.classAware ? "class-aware" : "class-agnostic") << (config.softNms ? ", soft" : ", hard") << ") "
+            << configuredMs << " ms (" << keep.size() << " kept)");
+    }
+}
@@ -0,0 +1,27 @@
+#ifndef NMS_H
+#define NMS_H
+
+#include <opencv2/core.hpp>
+#include <vector>
+
+struct NmsConfig {
+    float scoreThreshold = 0.2f;
+    float iouThreshold = 0.2f;
+    bool classAware = true; // boxes of different classes never suppress each other
+    bool softNms = false;   // Gaussian Soft-NMS: overlapping boxes lose score instead of being dropped
+    float softSigma = 0.5f;
+};
+
+// Greedy NMS over flat candidate arrays. Overlap search goes through a uniform grid of buckets sized
+// from the boxes, so each candidate is only tested against kept boxes in the cells it touches.
+// Hard NMS keeps the same boxes as cv::dnn::NMSBoxes when classAware is off.
+// keep receives the surviving indices, best score first. Soft-NMS writes the decayed scores of the
+// kept boxes back into scores.
+void nonMaxSuppression(const std::vector<cv::Rect>& boxes, std::vector<float>& scores, const std::vector<int>& classIds,
+    const NmsConfig& config, std::vector<int>& keep);
+
+// Times cv::dnn::NMSBoxes against nonMaxSuppression on 1k, 10k and 50k synthetic clustered
+// candidates spread over frameSize and logs the results
+void benchmarkNms(const cv::Size& frameSize, const NmsConfig& config, int iterations = 3);
+
+#endif // NMS_H
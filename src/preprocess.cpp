@@ -0,0 +1,403 @@
+#include "preprocess.h"
+#include "utils.h"
+
+#include <chrono>
+#include <cstring>
+#include <immintrin.h>
+
+// MSVC lets any TU use AVX2 intrinsics, GCC/Clang need the target enabled per function
+#if defined(__GNUC__) || defined(__clang__)
+#define TARGET_SSE41 __attribute__((target("sse4.1")))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define TARGET_SSE41
+#define TARGET_AVX2
+#endif
+
+namespace {
+
+// Source sampling tables for one (src size, dst size) pair. Matches cv::resize INTER_LINEAR:
+// half-pixel centers, clamped at the borders. x offsets are in bytes into a CV_8UC3 row.
+struct ResizeTables {
+    int srcWidth = 0, srcHeight = 0, dstWidth = 0, dstHeight = 0;
+    std::vector<int> x0, x1;
+    std::vector<float> ax;
+    std::vector<int> y0, y1;
+    std::vector<float> ay;
+    int simdEnd = 0; // SIMD paths load 4 bytes per pixel, stop before that can run past the row
+};
+
+void computeAxis(int srcSize, int dstSize, int elemSize, std::vector<int>& i0, std::vector<int>& i1, std::vector<float>& alpha) {
+    const double scale = static_cast<double>(srcSize) / dstSize;
+    i0.resize(dstSize);
+    i1.resize(dstSize);
+    alpha.resize(dstSize);
+
+    for (int d = 0; d < dstSize; ++d) {
+        float f = static_cast<float>((d + 0.5) * scale - 0.5);
+        int s = static_cast<int>(std::floor(f));
+        f -= s;
+        if (s < 0) {
+            s = 0;
+            f = 0.0f;
+        }
+        if (s >= srcSize - 1) {
+            s = srcSize - 1;
+            f = 0.0f;
+        }
+        i0[d] = s * elemSize;
+        i1[d] = std::min(s + 1, srcSize - 1) * elemSize;
+        alpha[d] = f;
+    }
+}
+
+const ResizeTables& getTables(int srcWidth, int srcHeight, int dstWidth, int dstHeight) {
+    // one cache per thread, tiles of a batch all share the same geometry
+    thread_local ResizeTables t;
+    if (t.srcWidth == srcWidth && t.srcHeight == srcHeight && t.dstWidth == dstWidth && t.dstHeight == dstHeight)
+        return t;
+
+    t.srcWidth = srcWidth;
+    t.srcHeight = srcHeight;
+    t.dstWidth = dstWidth;
+    t.dstHeight = dstHeight;
+    computeAxis(srcWidth, dstWidth, 3, t.x0, t.x1, t.ax);
+    computeAxis(srcHeight, dstHeight, 1, t.y0, t.y1, t.ay);
+
+    const int rowBytes = srcWidth * 3;
+    t.simdEnd = 0;
+    while (t.simdEnd < dstWidth && t.x1[t.simdEnd] + 4 <= rowBytes)
+        ++t.simdEnd;
+
+    return t;
+}
+
+// Horizontal pass: interpolates one source row into 3 normalized float rows (CHW order)
+typedef void (*HorizontalFn)(const uchar* src, const ResizeTables& t, float* const out[3], const int order[3]);
+// Vertical pass: dst = a + ay * (b - a), written straight into the tensor plane
+typedef void (*VerticalFn)(const float* a, const float* b, float ay, float* dst, int n);
+
+void horizontalRange(const uchar* src, const ResizeTables& t, int begin, int end, float* const out[3], const int order[3]) {
+    const float norm = 1.0f / 255.0f;
+    for (int x = begin; x < end; ++x) {
+        const uchar* p0 = src + t.x0[x];
+        const uchar* p1 = src + t.x1[x];
+        const float a = t.ax[x];
+        for (int c = 0; c < 3; ++c) {
+            float v0 = p0[order[c]];
+            float v1 = p1[order[c]];
+            out[c][x] = (v0 + a * (v1 - v0)) * norm;
+        }
+    }
+}
+
+void horizontalScalar(const uchar* src, const ResizeTables& t, float* const out[3], const int order[3]) {
+    horizontalRange(src, t, 0, t.dstWidth, out, order);
+}
+
+void verticalScalar(const float* a, const float* b, float ay, float* dst, int n) {
+    for (int i = 0; i < n; ++i)
+        dst[i] = a[i] + ay * (b[i] - a[i]);
+}
+
+// pshufb mask that zero-extends byte `channel` of every 32-bit lane
+inline int channelMask(int lane, int channel) {
+    return static_cast<int>(0x80808000u | static_cast<unsigned>(lane * 4 + channel));
+}
+
+TARGET_SSE41 void horizontalSSE41(const uchar* src, const ResizeTables& t, float* const out[3], const int order[3]) {
+    const __m128 norm = _mm_set1_ps(1.0f / 255.0f);
+    __m128i masks[3];
+    for (int c = 0; c < 3; ++c)
+        masks[c] = _mm_setr_epi32(channelMask(0, order[c]), channelMask(1, order[c]), channelMask(2, order[c]), channelMask(3, order[c]));
+
+    int x = 0;
+    for (; x + 4 <= t.simdEnd; x += 4) {
+        int w0[4], w1[4];
+        for (int k = 0; k < 4; ++k) {
+            std::memcpy(&w0[k], src + t.x0[x + k], 4);
+            std::memcpy(&w1[k], src + t.x1[x + k], 4);
+        }
+        const __m128i g0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(w0));
+        const __m128i g1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(w1));
+        const __m128 a = _mm_loadu_ps(t.ax.data() + x);
+
+        for (int c = 0; c < 3; ++c) {
+            __m128 v0 = _mm_cvtepi32_ps(_mm_shuffle_epi8(g0, masks[c]));
+            __m128 v1 = _mm_cvtepi32_ps(_mm_shuffle_epi8(g1, masks[c]));
+            __m128 v = _mm_add_ps(v0, _mm_mul_ps(a, _mm_sub_ps(v1, v0)));
+            _mm_storeu_ps(out[c] + x, _mm_mul_ps(v, norm));
+        }
+    }
+    horizontalRange(src, t, x, t.dstWidth, out, order);
+}
+
+TARGET_SSE41 void verticalSSE41(const float* a, const float* b, float ay, float* dst, int n) {
+    const __m128 w = _mm_set1_ps(ay);
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 va = _mm_loadu_ps(a + i);
+        __m128 vb = _mm_loadu_ps(b + i);
+        _mm_storeu_ps(dst + i, _mm_add_ps(va, _mm_mul_ps(w, _mm_sub_ps(vb, va))));
+    }
+    verticalScalar(a + i, b + i, ay, dst + i, n - i);
+}
+
+TARGET_AVX2 void horizontalAVX2(const uchar* src, const ResizeTables& t, float* const out[3], const int order[3]) {
+    const __m256 norm = _mm256_set1_ps(1.0f / 255.0f);
+    __m256i masks[3];
+    for (int c = 0; c < 3; ++c)
+        masks[c] = _mm256_broadcastsi128_si256(
+            _mm_setr_epi32(channelMask(0, order[c]), channelMask(1, order[c]), channelMask(2, order[c]), channelMask(3, order[c])));
+
+    const int* base = reinterpret_cast<const int*>(src);
+    int x = 0;
+    for (; x + 8 <= t.simdEnd; x += 8) {
+        const __m256i o0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(t.x0.data() + x));
+        const __m256i o1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(t.x1.data() + x));
+        const __m256i g0 = _mm256_i32gather_epi32(base, o0, 1);
+        const __m256i g1 = _mm256_i32gather_epi32(base, o1, 1);
+        const __m256 a = _mm256_loadu_ps(t.ax.data() + x);
+
+        for (int c = 0; c < 3; ++c) {
+            __m256 v0 = _mm256_cvtepi32_ps(_mm256_shuffle_epi8(g0, masks[c]));
+            __m256 v1 = _mm256_cvtepi32_ps(_mm256_shuffle_epi8(g1, masks[c]));
+            __m256 v = _mm256_add_ps(v0, _mm256_mul_ps(a, _mm256_sub_ps(v1, v0)));
+            _mm256_storeu_ps(out[c] + x, _mm256_mul_ps(v, norm));
+        }
+    }
+    horizontalRange(src, t, x, t.dstWidth, out, order);
+}
+
+TARGET_AVX2 void verticalAVX2(const float* a, const float* b, float ay, float* dst, int n) {
+    const __m256 w = _mm256_set1_ps(ay);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 va = _mm256_loadu_ps(a + i);
+        __m256 vb = _mm256_loadu_ps(b + i);
+        _mm256_storeu_ps(dst + i, _mm256_add_ps(va, _mm256_mul_ps(w, _mm256_sub_ps(vb, va))));
+    }
+    verticalScalar(a + i, b + i, ay, dst + i, n - i);
+}
+
+// Pack pass for native tiles: one source row straight into 3 normalized float rows, no interpolation
+typedef void (*PackRowFn)(const uchar* src, int width, float* const out[3], const int order[3]);
+
+void packRowRange(const uchar* src, int begin, int end, float* const out[3], const int order[3]) {
+    const float norm = 1.0f / 255.0f;
+    for (int x = begin; x < end; ++x) {
+        const uchar* p = src + 3 * x;
+        for (int c = 0; c < 3; ++c)
+            out[c][x] = p[order[c]] * norm;
+    }
+}
+
+void packRowScalar(const uchar* src, int width, float* const out[3], const int order[3]) {
+    packRowRange(src, 0, width, out, order);
+}
+
+// pshufb mask that zero-extends byte `channel` of packed 3-byte pixel `lane`
+inline int packedChannelMask(int lane, int channel) {
+    return static_cast<int>(0x80808000u | static_cast<unsigned>(lane * 3 + channel));
+}
+
+TARGET_SSE41 void packRowSSE41(const uchar* src, int width, float* const out[3], const int order[3]) {
+    const __m128 norm = _mm_set1_ps(1.0f / 255.0f);
+    __m128i masks[3];
+    for (int c = 0; c < 3; ++c)
+        masks[c] = _mm_setr_epi32(packedChannelMask(0, order[c]), packedChannelMask(1, order[c]),
+            packedChannelMask(2, order[c]), packedChannelMask(3, order[c]));
+
+    // 4 pixels per 16-byte load, stop while the load still ends inside the row
+    int x = 0;
+    for (; x + 6 <= width; x += 4) {
+        const __m128i px = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 3 * x));
+        for (int c = 0; c < 3; ++c)
+            _mm_storeu_ps(out[c] + x, _mm_mul_ps(_mm_cvtepi32_ps(_mm_shuffle_epi8(px, masks[c])), norm));
+    }
+    packRowRange(src, x, width, out, order);
+}
+
+TARGET_AVX2 void packRowAVX2(const uchar* src, int width, float* const out[3], const int order[3]) {
+    const __m256 norm = _mm256_set1_ps(1.0f / 255.0f);
+    __m256i masks[3];
+    for (int c = 0; c < 3; ++c)
+        masks[c] = _mm256_broadcastsi128_si256(_mm_setr_epi32(packedChannelMask(0, order[c]), packedChannelMask(1, order[c]),
+            packedChannelMask(2, order[c]), packedChannelMask(3, order[c])));
+
+    // two 4-pixel loads per 8 pixels, one per 128-bit lane
+    int x = 0;
+    for (; x + 10 <= width; x += 8) {
+        const __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 3 * x));
+        const __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 3 * x + 12));
+        const __m256i px = _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+        for (int c = 0; c < 3; ++c)
+            _mm256_storeu_ps(out[c] + x, _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_shuffle_epi8(px, masks[c])), norm));
+    }
+    float* tail[3] = { out[0] + x, out[1] + x, out[2] + x };
+    packRowSSE41(src + 3 * x, width - x, tail, order);
+}
+
+struct PreprocessKernel {
+    const char* name;
+    HorizontalFn horizontal;
+    VerticalFn vertical;
+    PackRowFn packRow;
+};
+
+const PreprocessKernel& selectKernel() {
+    static const PreprocessKernel kernel = [] {
+        if (cv::checkHardwareSupport(CV_CPU_AVX2))
+            return PreprocessKernel{ "AVX2", horizontalAVX2, verticalAVX2, packRowAVX2 };
+        if (cv::checkHardwareSupport(CV_CPU_SSE4_1))
+            return PreprocessKernel{ "SSE4.1", horizontalSSE41, verticalSSE41, packRowSSE41 };
+        return PreprocessKernel{ "scalar", horizontalScalar, verticalScalar, packRowScalar };
+    }();
+    return kernel;
+}
+
+} // namespace
+
+
+const char* preprocessKernelName() {
+    return selectKernel().name;
+}
+
+void preprocessTile(const cv::Mat& tile, float* dst, int dstWidth, int dstHeight, bool swapRB) {
+    if (tile.empty() || tile.type() != CV_8UC3) {
+        preprocessTileReference(tile, dst, dstWidth, dstHeight, swapRB);
+        return;
+    }
+
+    // bilinear at scale 1 is a plain copy
+    if (tile.cols == dstWidth && tile.rows == dstHeight) {
+        packTile(tile, dst, dstWidth, dstHeight, swapRB);
+        return;
+    }
+
+    const PreprocessKernel& kernel = selectKernel();
+    const ResizeTables& t = getTables(tile.cols, tile.rows, dstWidth, dstHeight);
+    const int order[3] = { swapRB ? 2 : 0, 1, swapRB ? 0 : 2 };
+    const size_t planeSize = static_cast<size_t>(dstWidth) * dstHeight;
+
+    // two cached source rows, each expanded to 3 float rows
+    thread_local std::vector<float> rowBuffer;
+    rowBuffer.resize(static_cast<size_t>(dstWidth) * 6);
+    float* rowA[3] = { rowBuffer.data(), rowBuffer.data() + dstWidth, rowBuffer.data() + 2 * dstWidth };
+    float* rowB[3] = { rowBuffer.data() + 3 * dstWidth, rowBuffer.data() + 4 * dstWidth, rowBuffer.data() + 5 * dstWidth };
+    int cachedA = -1;
+    int cachedB = -1;
+
+    for (int y = 0; y < dstHeight; ++y) {
+        const int sy0 = t.y0[y];
+        const int sy1 = t.y1[y];
+
+        if (sy0 != cachedA) {
+            if (sy0 == cachedB) {
+                std::swap(rowA, rowB);
+                std::swap(cachedA, cachedB);
+            }
+            else {
+                kernel.horizontal(tile.ptr<uchar>(sy0), t, rowA, order);
+                cachedA = sy0;
+            }
+        }
+        if (sy1 != cachedB) {
+            kernel.horizontal(tile.ptr<uchar>(sy1), t, rowB, order);
+            cachedB = sy1;
+        }
+
+        const float ay = t.ay[y];
+        for (int c = 0; c < 3; ++c)
+            kernel.vertical(rowA[c], rowB[c], ay, dst + c * planeSize + static_cast<size_t>(y) * dstWidth, dstWidth);
+    }
+}
+
+void packTile(const cv::Mat& tile, float* dst, int dstWidth, int dstHeight, bool swapRB) {
+    const int width = std::min(tile.cols, dstWidth);
+    const int height = std::min(tile.rows, dstHeight);
+
+    if (tile.empty() || tile.type() != CV_8UC3) {
+        cv::Mat padded;
+        cv::copyMakeBorder(tile(cv::Rect(0, 0, width, height)), padded, 0, dstHeight - height, 0, dstWidth - width,
+            cv::BORDER_CONSTANT, cv::Scalar::all(TILE_PAD_VALUE));
+        preprocessTileReference(padded, dst, dstWidth, dstHeight, swapRB);
+        return;
+    }
+
+    const PreprocessKernel& kernel = selectKernel();
+    const int order[3] = { swapRB ? 2 : 0, 1, swapRB ? 0 : 2 };
+    const size_t planeSize = static_cast<size_t>(dstWidth) * dstHeight;
+    const float pad = TILE_PAD_VALUE / 255.0f;
+
+    for (int y = 0; y < height; ++y) {
+        float* out[3];
+        for (int c = 0; c < 3; ++c)
+            out[c] = dst + c * planeSize + static_cast<size_t>(y) * dstWidth;
+
+        kernel.packRow(tile.ptr<uchar>(y), width, out, order);
+        if (width < dstWidth) {
+            for (int c = 0; c < 3; ++c)
+                std::fill(out[c] + width, out[c] + dstWidth, pad);
+        }
+    }
+
+    // rows below a cropped edge tile
+    if (height < dstHeight) {
+        for (int c = 0; c < 3; ++c)
+            std::fill(dst + c * planeSize + static_cast<size_t>(height) * dstWidth, dst + (c + 1) * planeSize, pad);
+    }
+}
+
+void preprocessTileReference(const cv::Mat& tile, float* dst, int dstWidth, int dstHeight, bool swapRB) {
+    cv::Mat resized;
+    cv::resize(tile, resized, cv::Size(dstWidth, dstHeight));
+    if (swapRB)
+        cv::cvtColor(resized, resized, cv::COLOR_BGR2RGB);
+
+    // Normalize and convert to float
+    cv::Mat normalized;
+    resized.convertTo(normalized, CV_32F, 1.0 / 255.0);
+
+    // Convert HWC to CHW format
+    std::vector<cv::Mat> channels(3);
+    cv::split(normalized, channels);
+
+    const size_t planeSize = static_cast<size_t>(dstWidth) * dstHeight;
+    for (int c = 0; c < 3; ++c) {
+        std::memcpy(dst + c * planeSize, channels[c].data, planeSize * sizeof(float));
+    }
+}
+
+void benchmarkPreprocess(const std::vector<cv::Mat>& tiles, int dstWidth, int dstHeight, int iterations) {
+    if (tiles.empty() || iterations <= 0) return;
+
+    const size_t tileSize = static_cast<size_t>(dstWidth) * dstHeight * 3;
+    std::vector<float> reference(tiles.size() * tileSize);
+    std::vector<float> fused(tiles.size() * tileSize);
+
+    auto timeRuns = [&](auto&& fn, std::vector<float>& out) {
+        // first run warms caches and the per-thread tables
+        for (size_t i = 0; i < tiles.size(); ++i)
+            fn(tiles[i], out.data() + i * tileSize, dstWidth, dstHeight, false);
+
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int it = 0; it < iterations; ++it)
+            for (size_t i = 0; i < tiles.size(); ++i)
+                fn(tiles[i], out.data() + i * tileSize, dstWidth, dstHeight, false);
+        auto end = std::chrono::high_resolution_clock::now();
+        return std::chrono::duration<double, std::milli>(end - start).count() / iterations;
+    };
+
+    double referenceMs = timeRuns(preprocessTileReference, reference);
+    double fusedMs = timeRuns(preprocessTile, fused);
+
+    float maxDiff = 0.0f;
+    for (size_t i = 0; i < reference.size(); ++i)
+        maxDiff = std::max(maxDiff, std::abs(reference[i] - fused[i]));
+
+    LOG_INFO("[BENCH] preprocess " << tiles.size() << " tiles " << tiles[0].cols << "x" << tiles[0].rows
+        << " -> " << dstWidth << "x" << dstHeight << ": reference " << referenceMs << " ms, fused ("
+        << preprocessKernelName() << ") " << fusedMs << " ms, speedup " << referenceMs / fusedMs
+        << "x, max abs diff " << maxDiff);
+}
@@ -0,0 +1,30 @@
+#ifndef PREPROCESS_H
+#define PREPROCESS_H
+
+#include <opencv2/opencv.hpp>
+
+
+// Fused tile preprocessing: bilinear resize + 1/255 normalize + HWC->CHW (+ optional R/B swap)
+// in a single pass. Writes 3 planes of dstWidth * dstHeight floats starting at dst, so callers
+// can point it straight at a tile's slice of the batched input tensor.
+// Expects CV_8UC3 input; anything else goes through the reference path.
+void preprocessTile(const cv::Mat& tile, float* dst, int dstWidth, int dstHeight, bool swapRB = false);
+
+// Native-resolution path, no resize: normalizes + HWC->CHW the tile into the top-left corner of the
+// dstWidth x dstHeight planes and pads the rest with TILE_PAD_VALUE. Larger tiles are cropped.
+// preprocessTile takes this path by itself when the tile already has the destination size.
+void packTile(const cv::Mat& tile, float* dst, int dstWidth, int dstHeight, bool swapRB = false);
+
+// YOLO letterbox gray, used for the padded part of edge tiles
+const int TILE_PAD_VALUE = 114;
+
+// Old resize -> convertTo -> split -> memcpy path, kept to validate and benchmark the fused kernel
+void preprocessTileReference(const cv::Mat& tile, float* dst, int dstWidth, int dstHeight, bool swapRB = false);
+
+// Name of the SIMD variant picked at runtime ("AVX2", "SSE4.1" or "scalar")
+const char* preprocessKernelName();
+
+// Times the reference and fused paths over the given tiles and logs the results
+void benchmarkPreprocess(const std::vector<cv::Mat>& tiles, int dstWidth, int dstHeight, int iterations = 10);
+
+#endif // PREPROCESS_H
@@ -0,0 +1,129 @@
+#include "replaysource.h"
+#include "utils.h"
+
+#include <opencv2/imgcodecs.hpp>
+
+#include <algorithm>
+#include <filesystem>
+#include <mutex>
+
+static std::mutex replayMutex;
+static ReplaySourceConfig replayConfig;
+
+void setReplaySourceConfig(const ReplaySourceConfig& config) {
+    std::lock_guard<std::mutex> lock(replayMutex);
+    replayConfig = config;
+}
+
+ReplaySourceConfig replaySourceConfig() {
+    std::lock_guard<std::mutex> lock(replayMutex);
+    return replayConfig;
+}
+
+bool ReplaySource::open(const std::string& path, size_t cacheBudgetBytes) {
+    namespace fs = std::filesystem;
+    m_cacheBudget = cacheBudgetBytes;
+
+    std::error_code ec;
+    if (fs::is_directory(path, ec)) {
+        for (const fs::directory_entry& entry : fs::directory_iterator(path, ec))
+            if (entry.is_regular_file() && cv::haveImageReader(entry.path().string()))
+                m_files.push_back(entry.path().string());
+        std::sort(m_files.begin(), m_files.end());
+        if (m_files.empty()) {
+            LOG_CRITICAL("No readable images in replay directory: " << path);
+            return false;
+        }
+    }
+    else if (!fs::exists(path, ec)) {
+        LOG_CRITICAL("Replay source does not exist: " << path);
+        return false;
+    }
+    else if (cv::haveImageReader(path)) {
+        m_files.push_back(path);
+    }
+    else if (!m_video.open(path)) {
+        LOG_CRITICAL("Replay source is neither an image nor a readable video: " << path);
+        return false;
+    }
+
+    // the first frame tells the resolution, and stays cached for the first read
+    cv::Mat first;
+    if (!decodeNext(first)) {
+        LOG_CRITICAL("Replay source has no frames: " << path);
+        return false;
+    }
+    m_frameSize = first.size();
+    m_nextCached = 0;
+    m_opened = true;
+
+    LOG_INFO("Replaying " << path << " (" << (m_video.isOpened() ? "video" : std::to_string(m_files.size()) + " image(s)")
+        << ") at " << m_frameSize.width << "x" << m_frameSize.height);
+    return true;
+}
+
+bool ReplaySource::decodeNext(cv::Mat& frame) {
+    // decoded into a fresh Mat while caching, into the reused buffer once the cache is given up
+    cv::Mat decoded;
+    cv::Mat& target = m_caching ? decoded : m_decodeBuffer;
+
+    if (m_video.isOpened()) {
+        if (!m_video.read(target)) return false;
+    }
+    else {
+        // unreadable files in a directory are skipped
+        target.release();
+        while (target.empty() && m_nextFile < m_files.size())
+            target = cv::imread(m_files[m_nextFile++]);
+        if (target.empty()) return false;
+    }
+
+    if (m_caching) {
+        m_cacheBytes += decoded.total() * decoded.elemSize();
+        if (m_cacheBytes > m_cacheBudget && !m_cache.empty()) {
+            LOG_WARNING("Replay source exceeds the " << m_cacheBudget / (1024 * 1024) << " MB frame cache, decoding while replaying");
+            m_cache.clear();
+            m_caching = false;
+        }
+        else {
+            m_cache.push_back(decoded);
+        }
+    }
+    frame = m_caching ? decoded : target;
+    return true;
+}
+
+void ReplaySource::rewind() {
+    if (m_video.isOpened()) m_video.set(cv::CAP_PROP_POS_FRAMES, 0);
+    m_nextFile = 0;
+}
+
+bool ReplaySource::read(cv::Mat& frame) {
+    if (!m_opened) return false;
+
+    if (m_cached) {
+        frame = m_cache[m_nextCached];
+        m_nextCached = (m_nextCached + 1) % m_cache.size();
+        return true;
+    }
+
+    // the frame open() decoded is still the next one to show
+    if (m_nextCached < m_cache.size()) {
+        frame = m_cache[m_nextCached++];
+        return true;
+    }
+
+    if (decodeNext(frame)) {
+        m_nextCached = m_cache.size();
+        return true;
+    }
+
+    // end of the first pass: the whole source is cached, or it is decoded again from the start
+    if (m_caching) {
+        m_cached = true;
+        m_nextCached = 0;
+        return read(frame);
+    }
+    rewind();
+    return decodeNext(frame);
+}
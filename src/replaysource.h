@@ -0,0 +1,56 @@
+#ifndef REPLAYSOURCE_H
+#define REPLAYSOURCE_H
+
+#include <opencv2/core.hpp>
+#include <opencv2/videoio.hpp>
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// What the IMG camera slot replays. The arducam slot is IMG for now, the micro cams open their devices
+// unless enabled is set, then they replay the same source too.
+struct ReplaySourceConfig {
+    bool enabled = false;              // micro cams replay the source instead of opening their devices
+    std::string path = "test_img.png"; // still image, directory of frames or video file
+    double fps = 0.0;                  // replay rate, 0 = the fps the camera was opened with
+    size_t cacheBudgetMB = 1024;       // decoded frames kept in memory, longer sources are decoded while replaying
+};
+
+void setReplaySourceConfig(const ReplaySourceConfig& config);
+ReplaySourceConfig replaySourceConfig();
+
+// File-backed stand-in for a camera: replays a still image, a directory of frames (sorted by name)
+// or a video file in a loop, BGR like cv::VideoCapture. Frames are decoded once on the first pass
+// and replayed from memory afterwards, unless the source doesn't fit the cache budget.
+class ReplaySource {
+public:
+    bool open(const std::string& path, size_t cacheBudgetBytes);
+    bool isOpened() const { return m_opened; }
+
+    // Next frame, wrapping around at the end. The frame may be shared with the cache, read it only.
+    bool read(cv::Mat& frame);
+
+    cv::Size frameSize() const { return m_frameSize; }
+
+private:
+    // next frame of the first pass, false at the end of the source
+    bool decodeNext(cv::Mat& frame);
+    void rewind();
+
+    bool m_opened = false;
+    std::vector<std::string> m_files; // image or directory
+    size_t m_nextFile = 0;
+    cv::VideoCapture m_video;
+    cv::Mat m_decodeBuffer;           // reused when frames are not cached
+
+    std::vector<cv::Mat> m_cache;
+    size_t m_cacheBytes = 0;
+    size_t m_cacheBudget = 0;
+    bool m_caching = true;            // first pass still fills the cache
+    bool m_cached = false;            // whole source in m_cache
+    size_t m_nextCached = 0;
+    cv::Size m_frameSize;
+};
+
+#endif // REPLAYSOURCE_H
@@ -0,0 +1,148 @@
+#include "selftests.h"
+#include "allocationcounter.h"
+#include "captureoutputs.h"
+#include "inferenceworker.h"
+#include "latestframe.h"
+#include "replaysource.h"
+#include "triplebuffer.h"
+#include "utils.h"
+
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include <atomic>
+#include <cstddef>
+
+namespace {
+
+// Counts the Mat buffers OpenCV allocates (cv::fastMalloc underneath, invisible to operator new).
+// Wraps the standard allocator, Mats over external data are not counted.
+class CountingMatAllocator : public cv::MatAllocator {
+public:
+    cv::UMatData* allocate(int dims, const int* sizes, int type, void* data, size_t* step,
+        cv::AccessFlag flags, cv::UMatUsageFlags usageFlags) const override {
+        if (!data) m_count.fetch_add(1, std::memory_order_relaxed);
+        return m_std->allocate(dims, sizes, type, data, step, flags, usageFlags);
+    }
+    bool allocate(cv::UMatData* data, cv::AccessFlag flags, cv::UMatUsageFlags usageFlags) const override {
+        return m_std->allocate(data, flags, usageFlags);
+    }
+    void deallocate(cv::UMatData* data) const override { m_std->deallocate(data); }
+
+    size_t count() const { return m_count.load(std::memory_order_relaxed); }
+
+private:
+    cv::MatAllocator* m_std = cv::Mat::getStdAllocator();
+    mutable std::atomic<size_t> m_count{ 0 };
+};
+
+// default allocator of every new Mat while in scope
+class ScopedMatAllocator {
+public:
+    explicit ScopedMatAllocator(cv::MatAllocator* allocator) : m_previous(cv::Mat::getDefaultAllocator()) {
+        cv::Mat::setDefaultAllocator(allocator);
+    }
+    ~ScopedMatAllocator() { cv::Mat::setDefaultAllocator(m_previous); }
+
+private:
+    cv::MatAllocator* m_previous;
+};
+
+bool check(bool ok, const char* name, const std::string& detail) {
+    if (ok) LOG_INFO("[SELFTEST] PASS " << name << ": " << detail);
+    else LOG_CRITICAL("[SELFTEST] FAIL " << name << ": " << detail);
+    return ok;
+}
+
+// The camera loop's per-frame work with its real consumers: the UI triple buffer showing every other
+// frame and the live detector holding its frame for three. Once the pools are warm no frame may be
+// allocated. The warm-up has to allocate, otherwise the counter does not see the pool's buffers.
+bool testCaptureAllocations(bool fullFrame, const char* name) {
+    CaptureOutputs outputs;
+    TripleFrameBuffer ui;
+    LatestFrameSlot live;
+    const cv::Mat source(720, 1280, CV_8UC3, cv::Scalar(30, 60, 90));
+
+    CountingMatAllocator counter;
+    ScopedMatAllocator scope(&counter);
+
+    cv::Mat shown, detecting;
+    int64_t capturedAtMs = 0;
+    cv::Size fullSize;
+    auto captureFrames = [&](int count) {
+        for (int i = 0; i < count; ++i) {
+            cv::Mat frame, preview;
+            outputs.convert(source, fullFrame, 0.5, frame, preview);
+            if (fullFrame) live.put(frame, i);
+            ui.publish(preview, i, source.size());
+
+            if (i % 2 == 0) ui.takeLatest(shown, capturedAtMs, fullSize);
+            if (fullFrame && i % 3 == 0) live.take(detecting, capturedAtMs);
+        }
+    };
+
+    captureFrames(30);
+    const size_t warmUp = counter.count();
+    captureFrames(300);
+    const size_t steady = counter.count() - warmUp;
+
+    return check(warmUp > 0 && steady == 0, name,
+        std::to_string(warmUp) + " Mat allocations warming up, " + std::to_string(steady) + " in 300 steady frames");
+}
+
+// Steady macro predictions with drawing off: split, content check, preprocess, run, decode, seam merge,
+// NMS and path. Counts every Mat buffer and, in COUNT_ALLOCATIONS builds, our heap (operator new).
+// Allocations inside ORT (its arena and kernels) are not seen by either counter.
+bool testInferenceAllocations() {
+    const char* name = "inference with postprocessing";
+    InferenceWorker worker;
+    worker.setDrawResults(false);
+    worker.initialize();
+    if (!worker.isReady())
+        return check(false, name, "no session, model expected at " + InferenceWorker::modelPathFor(worker.modelPrecision()));
+
+    // the replay image when there is one, otherwise dark blobs on agar so the tiles are not all skipped
+    cv::Mat frame = cv::imread(replaySourceConfig().path);
+    if (frame.empty()) {
+        frame = cv::Mat(1080, 1920, CV_8UC3, cv::Scalar(170, 160, 150));
+        for (int i = 0; i < 40; ++i)
+            cv::ellipse(frame, cv::Point(100 + (i * 397) % 1720, 100 + (i * 211) % 880), cv::Size(40, 6), i * 23.0, 0, 360,
+                cv::Scalar(60, 50, 40), cv::FILLED);
+    }
+    cv::cvtColor(frame, frame, cv::COLOR_BGR2RGB);
+    const TileGridConfig config;
+
+    CountingMatAllocator counter;
+    ScopedMatAllocator scope(&counter);
+
+    // the first predictions tune the micro-batch count and size the per-thread scratch buffers
+    const int warmUp = 20;
+    const int steadyRuns = 20;
+    for (int i = 0; i < warmUp; ++i)
+        worker.runDetection(frame, config);
+
+    const size_t heapBefore = allocationCount();
+    const size_t matsBefore = counter.count();
+    size_t detections = 0;
+    for (int i = 0; i < steadyRuns; ++i)
+        detections = worker.runDetection(frame, config).boxes.size();
+    const size_t heap = allocationCount() - heapBefore;
+    const size_t mats = counter.count() - matsBefore;
+
+    const std::string heapCount = allocationCountingEnabled() ? std::to_string(heap) + " heap" : "heap not counted (release build)";
+    return check(heap == 0 && mats == 0, name, heapCount + " and " + std::to_string(mats)
+        + " Mat allocations in " + std::to_string(steadyRuns) + " steady predictions (" + std::to_string(detections) + " detections)");
+}
+
+} // namespace
+
+
+int runSelfTests() {
+    bool ok = true;
+    ok &= testCaptureAllocations(true, "capture with live detection");
+    ok &= testCaptureAllocations(false, "capture preview only");
+    ok &= testInferenceAllocations();
+
+    LOG_INFO("[SELFTEST] " << (ok ? "all checks passed" : "checks failed"));
+    return ok ? 0 : 1;
+}
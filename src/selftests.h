@@ -0,0 +1,8 @@
+#ifndef SELFTESTS_H
+#define SELFTESTS_H
+
+// Checks that need no camera or UI, run with: Injector_app.exe --self-test
+// Logs every check and returns a process exit code, 0 when all of them passed.
+int runSelfTests();
+
+#endif // SELFTESTS_H
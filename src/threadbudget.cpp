@@ -0,0 +1,150 @@
+#include "threadbudget.h"
+#include "utils.h"
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+static std::mutex budgetMutex;
+static ThreadBudgetConfig budget;
+static std::atomic<uint64_t> uiFrames{ 0 };
+static std::atomic<uint64_t> previewFrames{ 0 };
+
+void setThreadBudgetConfig(const ThreadBudgetConfig& config) {
+    std::lock_guard<std::mutex> lock(budgetMutex);
+    budget = config;
+}
+
+ThreadBudgetConfig threadBudgetConfig() {
+    std::lock_guard<std::mutex> lock(budgetMutex);
+    return budget;
+}
+
+static int machineCores() {
+    return std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+}
+
+int reservedCoresFor(const ThreadBudgetConfig& config) {
+    const int cores = machineCores();
+    // scales with the machine, a 4-core laptop keeps 3 cores for inference
+    const int reserved = config.reservedCores < 0 ? std::min(5, cores / 4) : config.reservedCores;
+    return std::clamp(reserved, 0, cores - 1);
+}
+
+static RoleThreads threadsFor(const ThreadBudgetConfig& config, ThreadRole role, int index) {
+    const int reserved = reservedCoresFor(config);
+    const int inferenceCores = machineCores() - reserved;
+
+    // a third of the inference cores for the live detectors, never all of them, the macro service keeps the rest
+    const int sessions = std::max(0, config.liveSessions);
+    const int liveCores = sessions > 0 && inferenceCores > 1 ? std::max(1, inferenceCores / 3) : 0;
+    const int macroCores = inferenceCores - liveCores;
+
+    RoleThreads threads;
+
+    switch (role) {
+    case ThreadRole::MacroInference:
+        threads.allowSpinning = config.macroSpinning;
+        threads.intraOpThreads = macroCores;
+        threads.interOpThreads = std::max(1, config.interOpThreads);
+        threads.opencvThreads = macroCores;
+        threads.firstCore = 0;
+        threads.coreCount = macroCores;
+        break;
+
+    case ThreadRole::LiveInference: {
+        // disjoint slices after the macro cores, detectors share one only when there are fewer cores than detectors
+        threads.allowSpinning = config.liveSpinning;
+        if (liveCores == 0) {
+            threads.coreCount = inferenceCores; // single inference core, shared with the macro service
+            break;
+        }
+        const int share = std::max(1, liveCores / std::max(1, sessions));
+        threads.intraOpThreads = share;
+        threads.firstCore = macroCores + std::min(std::max(index, 0) % std::max(1, sessions) * share, liveCores - share);
+        threads.coreCount = share;
+        break;
+    }
+
+    case ThreadRole::Camera:
+    case ThreadRole::Stage: {
+        // one reserved core each: the cameras by type, then the stage, the last one is the UI's.
+        // Short of cores the cameras share theirs and the stage shares the UI's, never a camera's.
+        const int cameraCount = 3;
+        const int slotCount = reserved - 1;
+        if (reserved <= 0) break;
+        if (role == ThreadRole::Stage)
+            threads.firstCore = inferenceCores + (slotCount > cameraCount ? cameraCount : reserved - 1);
+        else if (slotCount > 0)
+            threads.firstCore = inferenceCores + std::max(index, 0) % std::min(slotCount, cameraCount);
+        else
+            break;
+        threads.coreCount = 1;
+        break;
+    }
+    }
+
+    if (!config.pinThreads) threads.coreCount = 0;
+    return threads;
+}
+
+RoleThreads threadsForRole(ThreadRole role, int index) {
+    return threadsFor(threadBudgetConfig(), role, index);
+}
+
+std::string intraOpAffinities(const RoleThreads& threads) {
+    if (threads.coreCount <= 0) return {};
+
+    // ORT pins its intraOpThreads - 1 pool threads, the calling thread is the first one of the pool.
+    // Processor ids are 1-based.
+    std::string affinities;
+    for (int t = 1; t < threads.intraOpThreads; ++t) {
+        if (!affinities.empty()) affinities += ';';
+        affinities += std::to_string(threads.firstCore + t % threads.coreCount + 1);
+    }
+    return affinities;
+}
+
+void pinCurrentThread(const RoleThreads& threads) {
+    if (threads.coreCount <= 0) return;
+
+#ifdef _WIN32
+    DWORD_PTR mask = 0;
+    for (int core = threads.firstCore; core < threads.firstCore + threads.coreCount && core < 64; ++core)
+        mask |= DWORD_PTR(1) << core;
+    if (!SetThreadAffinityMask(GetCurrentThread(), mask))
+        LOG_WARNING("Could not pin thread to cores " << threads.firstCore << "-" << threads.firstCore + threads.coreCount - 1);
+#else
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int core = threads.firstCore; core < threads.firstCore + threads.coreCount; ++core)
+        CPU_SET(core, &set);
+    if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0)
+        LOG_WARNING("Could not pin thread to cores " << threads.firstCore << "-" << threads.firstCore + threads.coreCount - 1);
+#endif
+}
+
+std::string describeThreadBudget(const ThreadBudgetConfig& config) {
+    const RoleThreads macro = threadsFor(config, ThreadRole::MacroInference, 0);
+    std::ostringstream text;
+    text << "reserved " << reservedCoresFor(config) << (config.reservedCores < 0 ? " auto" : "") << " (intra-op " << macro.intraOpThreads << ", inter-op "
+         << macro.interOpThreads << "), spinning macro " << (config.macroSpinning ? "on" : "off")
+         << ", live " << (config.liveSpinning ? "on" : "off")
+         << ", pinning " << (config.pinThreads ? "on" : "off");
+    return text.str();
+}
+
+void countUiFrame() { uiFrames.fetch_add(1, std::memory_order_relaxed); }
+void countPreviewFrame() { previewFrames.fetch_add(1, std::memory_order_relaxed); }
+uint64_t uiFrameCount() { return uiFrames.load(std::memory_order_relaxed); }
+uint64_t previewFrameCount() { return previewFrames.load(std::memory_order_relaxed); }
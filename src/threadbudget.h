@@ -0,0 +1,62 @@
+#ifndef THREADBUDGET_H
+#define THREADBUDGET_H
+
+#include <cstdint>
+#include <string>
+
+// Who a thread or thread pool works for
+enum class ThreadRole {
+    MacroInference, // macro prediction service: ORT pool + OpenCV pool
+    LiveInference,  // one live detector per micro cam, index = which one
+    Camera,         // CameraWorker capture loop, index = cameraType
+    Stage           // XYZStage serial worker
+};
+
+// Process-wide split of the cores. The first (cores - reservedCores) run inference, the reserved
+// ones are left to the UI, capture and stage threads so the preview keeps up during a prediction.
+// The inference cores are split again: the macro service gets the front, the live detectors the rest.
+struct ThreadBudgetConfig {
+    int reservedCores = -1;     // -1 = min(5, cores / 4): three cameras, the stage and the UI on big machines
+    int liveSessions = 2;       // live detectors split their part of the inference cores evenly
+    int interOpThreads = 1;     // > 1 switches ORT to the parallel executor
+    // ORT pool threads spin before sleeping: a bit less latency, but they hold on to their cores.
+    // Per role, the live detectors run back to back while the macro service mostly waits for requests.
+    bool macroSpinning = false;
+    bool liveSpinning = false;
+    bool pinThreads = false;    // pin every role to its own cores
+};
+
+// What one thread or session of a role gets
+struct RoleThreads {
+    int intraOpThreads = 1;
+    int interOpThreads = 1;
+    int opencvThreads = 0;      // cv::setNumThreads is process-wide, 0 = leave it alone
+    bool allowSpinning = false;
+    int firstCore = 0;          // 0-based, the role runs on [firstCore, firstCore + coreCount)
+    int coreCount = 0;          // 0 = not pinned
+};
+
+void setThreadBudgetConfig(const ThreadBudgetConfig& config);
+ThreadBudgetConfig threadBudgetConfig();
+
+RoleThreads threadsForRole(ThreadRole role, int index = 0);
+
+// ORT intra-op affinity string for the role's pool threads (session.intra_op_thread_affinities),
+// empty when the role is not pinned
+std::string intraOpAffinities(const RoleThreads& threads);
+
+// pins the calling thread to the role's cores, no-op when pinning is off
+void pinCurrentThread(const RoleThreads& threads);
+
+// cores left to UI, capture and stage under config, resolves the -1 default
+int reservedCoresFor(const ThreadBudgetConfig& config);
+
+std::string describeThreadBudget(const ThreadBudgetConfig& config);
+
+// UI and preview frame counters, the thread budget benchmark reports them next to inference latency
+void countUiFrame();
+void countPreviewFrame();
+uint64_t uiFrameCount();
+uint64_t previewFrameCount();
+
+#endif // THREADBUDGET_H
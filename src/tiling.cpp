@@ -0,0 +1,238 @@
+#include "tiling.h"
+
+#include <numeric>
+
+int nativeTileSide(const TileGridConfig& config) {
+    return std::max(32, config.nativeTileSize / 32 * 32);
+}
+
+// fixed tile size: enough tiles that neighbours share at least `overlap` of a tile
+static int nativeTileCount(int imageSide, int tileSide, float overlap) {
+    if (imageSide <= tileSide) return 1;
+    const int stride = std::max(1, static_cast<int>(tileSide * (1.0f - overlap)));
+    return (imageSide - tileSide + stride - 1) / stride + 1;
+}
+
+void buildTileGrid(const cv::Size& imageSize, const TileGridConfig& config, TileGrid& grid) {
+    grid.imageSize = imageSize;
+    const float overlap = std::min(std::max(config.overlap, 0.0f), 0.9f);
+
+    if (config.nativeResolution) {
+        grid.tileWidth = grid.tileHeight = nativeTileSide(config);
+        grid.cols = nativeTileCount(imageSize.width, grid.tileWidth, overlap);
+        grid.rows = nativeTileCount(imageSize.height, grid.tileHeight, overlap);
+    }
+    else {
+        grid.cols = std::max(1, config.cols);
+        grid.rows = std::max(1, config.rows);
+
+        // n tiles of width t overlapping by overlap * t cover W = t * (n - (n - 1) * overlap)
+        grid.tileWidth = static_cast<int>(std::ceil(imageSize.width / (grid.cols - (grid.cols - 1) * overlap)));
+        grid.tileHeight = static_cast<int>(std::ceil(imageSize.height / (grid.rows - (grid.rows - 1) * overlap)));
+        grid.tileWidth = std::min(grid.tileWidth, imageSize.width);
+        grid.tileHeight = std::min(grid.tileHeight, imageSize.height);
+    }
+
+    const double strideX = grid.cols > 1 ? static_cast<double>(imageSize.width - grid.tileWidth) / (grid.cols - 1) : 0.0;
+    const double strideY = grid.rows > 1 ? static_cast<double>(imageSize.height - grid.tileHeight) / (grid.rows - 1) : 0.0;
+    const cv::Rect imageRect(cv::Point(0, 0), imageSize);
+
+    grid.tiles.clear();
+    grid.tiles.reserve(grid.cols * grid.rows);
+    for (int r = 0; r < grid.rows; ++r) {
+        for (int c = 0; c < grid.cols; ++c) {
+            // first and last tiles sit flush with the image borders
+            int x = static_cast<int>(std::lround(c * strideX));
+            int y = static_cast<int>(std::lround(r * strideY));
+            // only a native tile bigger than the image gets clipped, the model sees the rest as padding
+            grid.tiles.push_back(cv::Rect(x, y, grid.tileWidth, grid.tileHeight) & imageRect);
+        }
+    }
+}
+
+bool tileHasContent(const cv::Mat& tile, const TileContentConfig& config) {
+    if (tile.empty()) return false;
+
+    // area averaging keeps a worm thinner than the factor as a faint blip instead of skipping it
+    thread_local cv::Mat small, gray;
+    const double factor = 1.0 / std::max(config.downsample, 1);
+    cv::resize(tile, small, cv::Size(), factor, factor, cv::INTER_AREA);
+    if (small.channels() == 3)
+        cv::cvtColor(small, gray, cv::COLOR_RGB2GRAY); // frames are RGB once captured
+    else
+        gray = small;
+
+    if (gray.rows < 2 || gray.cols < 2) return true;
+
+    int foreground = 0;
+    int edges = 0;
+    for (int y = 0; y < gray.rows - 1; ++y) {
+        const uchar* row = gray.ptr<uchar>(y);
+        const uchar* next = gray.ptr<uchar>(y + 1);
+        for (int x = 0; x < gray.cols - 1; ++x) {
+            const int v = row[x];
+            if (v <= config.darkThreshold) continue;
+            ++foreground;
+
+            const int dx = std::abs(row[x + 1] - v);
+            const int dy = std::abs(next[x] - v);
+            if (std::max(dx, dy) > config.edgeThreshold) ++edges;
+        }
+    }
+
+    const float foregroundFraction = static_cast<float>(foreground) / ((gray.rows - 1) * (gray.cols - 1));
+    return foregroundFraction >= config.minForegroundFraction && edges >= config.minEdgePixels;
+}
+
+cv::Rect remapTileBox(float cx, float cy, float w, float h, float scaleX, float scaleY, const cv::Rect& tile) {
+    // Convert from center coordinates to top-left coordinates
+    float x1 = (cx - w / 2) * scaleX;
+    float y1 = (cy - h / 2) * scaleY;
+    float x2 = (cx + w / 2) * scaleX;
+    float y2 = (cy + h / 2) * scaleY;
+
+    // Clamp to tile bounds
+    x1 = std::max(0.0f, std::min(x1, static_cast<float>(tile.width)));
+    y1 = std::max(0.0f, std::min(y1, static_cast<float>(tile.height)));
+    x2 = std::max(0.0f, std::min(x2, static_cast<float>(tile.width)));
+    y2 = std::max(0.0f, std::min(y2, static_cast<float>(tile.height)));
+
+    return cv::Rect(cv::Point(x1 + tile.x, y1 + tile.y), cv::Point(x2 + tile.x, y2 + tile.y));
+}
+
+namespace {
+
+// Edges of the tile the box was clipped against, only counting edges inside the image
+struct Truncation {
+    bool vertical = false;   // clipped by a left/right seam
+    bool horizontal = false; // clipped by a top/bottom seam
+};
+
+Truncation truncation(const cv::Rect& box, const cv::Rect& tile, const cv::Size& imageSize, int margin) {
+    Truncation t;
+    t.vertical = (tile.x > 0 && box.x <= tile.x + margin) ||
+        (tile.br().x < imageSize.width && box.br().x >= tile.br().x - margin);
+    t.horizontal = (tile.y > 0 && box.y <= tile.y + margin) ||
+        (tile.br().y < imageSize.height && box.br().y >= tile.br().y - margin);
+    return t;
+}
+
+float overlapRatio(int a0, int a1, int b0, int b1) {
+    int overlap = std::min(a1, b1) - std::max(a0, b0);
+    int shorter = std::min(a1 - a0, b1 - b0);
+    return shorter > 0 ? static_cast<float>(overlap) / shorter : 0.0f;
+}
+
+int findRoot(std::vector<int>& parent, int i) {
+    while (parent[i] != i) {
+        parent[i] = parent[parent[i]];
+        i = parent[i];
+    }
+    return i;
+}
+
+// Scratch space reused between calls on the same thread, the merged arrays swap with the caller's
+struct MergeWorkspace {
+    std::vector<int> candidates;
+    std::vector<Truncation> truncations;
+    std::vector<int> parent;
+    std::vector<int> slot;
+    std::vector<cv::Rect> mergedBoxes;
+    std::vector<float> mergedConfidences;
+    std::vector<int> mergedClassIds;
+    std::vector<int> mergedTileIds;
+};
+
+} // namespace
+
+void mergeCrossTileDuplicates(const TileGrid& grid, std::vector<cv::Rect>& boxes, std::vector<float>& confidences,
+    std::vector<int>& classIds, std::vector<int>& tileIds) {
+    const int margin = 2;
+    const float minSeamOverlap = 0.5f;
+
+    thread_local MergeWorkspace ws;
+    std::vector<int>& candidates = ws.candidates;
+    std::vector<Truncation>& truncations = ws.truncations;
+    std::vector<int>& parent = ws.parent;
+
+    // only boxes clipped by a seam can be halves of a split detection
+    candidates.clear();
+    truncations.resize(boxes.size());
+    for (int i = 0; i < static_cast<int>(boxes.size()); ++i) {
+        truncations[i] = truncation(boxes[i], grid.tiles[tileIds[i]], grid.imageSize, margin);
+        if (truncations[i].vertical || truncations[i].horizontal)
+            candidates.push_back(i);
+    }
+    if (candidates.empty()) return;
+
+    parent.resize(boxes.size());
+    std::iota(parent.begin(), parent.end(), 0);
+    bool merged = false;
+
+    for (int i : candidates) {
+        const cv::Rect grownI(boxes[i].x - margin, boxes[i].y - margin, boxes[i].width + 2 * margin, boxes[i].height + 2 * margin);
+        const cv::Rect& tileI = grid.tiles[tileIds[i]];
+
+        for (int j = 0; j < static_cast<int>(boxes.size()); ++j) {
+            if (tileIds[j] == tileIds[i] || classIds[j] != classIds[i]) continue;
+
+            // partner has to come from a neighbouring (touching or overlapping) tile
+            const cv::Rect& tileJ = grid.tiles[tileIds[j]];
+            cv::Rect grownTile(tileI.x - 1, tileI.y - 1, tileI.width + 2, tileI.height + 2);
+            if ((grownTile & tileJ).empty()) continue;
+
+            if ((grownI & boxes[j]).empty()) continue;
+
+            // the two parts have to line up along the seam they were cut at
+            bool alignedAcross = truncations[i].vertical &&
+                overlapRatio(boxes[i].y, boxes[i].br().y, boxes[j].y, boxes[j].br().y) > minSeamOverlap;
+            bool alignedAlong = truncations[i].horizontal &&
+                overlapRatio(boxes[i].x, boxes[i].br().x, boxes[j].x, boxes[j].br().x) > minSeamOverlap;
+            if (!alignedAcross && !alignedAlong) continue;
+
+            int rootI = findRoot(parent, i);
+            int rootJ = findRoot(parent, j);
+            if (rootI != rootJ) {
+                parent[std::max(rootI, rootJ)] = std::min(rootI, rootJ);
+                merged = true;
+            }
+        }
+    }
+    if (!merged) return;
+
+    // collapse every group into its first member, keeping the original order
+    std::vector<cv::Rect>& mergedBoxes = ws.mergedBoxes;
+    std::vector<float>& mergedConfidences = ws.mergedConfidences;
+    std::vector<int>& mergedClassIds = ws.mergedClassIds;
+    std::vector<int>& mergedTileIds = ws.mergedTileIds;
+    std::vector<int>& slot = ws.slot;
+    mergedBoxes.clear();
+    mergedConfidences.clear();
+    mergedClassIds.clear();
+    mergedTileIds.clear();
+    slot.assign(boxes.size(), -1);
+
+    for (int i = 0; i < static_cast<int>(boxes.size()); ++i) {
+        int root = findRoot(parent, i);
+        if (slot[root] < 0) {
+            slot[root] = static_cast<int>(mergedBoxes.size());
+            mergedBoxes.push_back(boxes[i]);
+            mergedConfidences.push_back(confidences[i]);
+            mergedClassIds.push_back(classIds[i]);
+            mergedTileIds.push_back(tileIds[i]);
+            continue;
+        }
+
+        int s = slot[root];
+        mergedBoxes[s] |= boxes[i];
+        if (confidences[i] > mergedConfidences[s]) {
+            mergedConfidences[s] = confidences[i];
+            mergedTileIds[s] = tileIds[i];
+        }
+    }
+
+    boxes.swap(mergedBoxes);
+    confidences.swap(mergedConfidences);
+    classIds.swap(mergedClassIds);
+    tileIds.swap(mergedTileIds);
+}
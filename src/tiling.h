@@ -0,0 +1,67 @@
+#ifndef TILING_H
+#define TILING_H
+
+#include <opencv2/opencv.hpp>
+
+// Runtime tiling setup for batched inference
+struct TileGridConfig {
+    int cols = 4;
+    int rows = 4;
+    float overlap = 0.1f; // fraction of a tile shared with its neighbour, 0 = edge to edge
+    bool skipEmptyTiles = true; // drop tiles that fail tileHasContent from the batch
+
+    // Native mode ignores cols/rows: square tiles of nativeTileSize are cut until they cover the image
+    // with at least `overlap`, and go to the model unscaled (model input = tile size).
+    bool nativeResolution = false;
+    int nativeTileSize = 640;
+
+    // Cascade: one downscaled whole-frame pass first, then only tiles touching one of its candidates
+    // (grown by cascadeMargin frame pixels) run at full resolution. Loose threshold, a missed region loses its worms.
+    bool cascade = false;
+    float cascadeThreshold = 0.1f;
+    int cascadeMargin = 64;
+};
+
+// Tile side used in native mode, rounded down to the model's 32 px stride
+int nativeTileSide(const TileGridConfig& config);
+
+// Thresholds of the empty-tile pre-check. Deliberately loose: a dropped tile loses its worms, an
+// extra tile only costs a batch slot.
+struct TileContentConfig {
+    int downsample = 8;                  // tile is area-averaged by this factor before the test
+    int darkThreshold = 10;              // same cut as cropInputImage, below it is outside the dish
+    float minForegroundFraction = 0.02f; // less non-black area than this is background
+    int edgeThreshold = 12;              // gray step between neighbouring downsampled pixels
+    int minEdgePixels = 3;               // flat agar has (almost) none
+};
+
+// All tiles have the same size so they share one resize scale. tiles[i] is the tile -> image offset
+// table used to map detections back: row-major, index = row * cols + col. In native mode a tile can be
+// clipped by an image smaller than the tile, tileWidth/tileHeight stay the unclipped (model) size.
+struct TileGrid {
+    cv::Size imageSize;
+    int cols = 0;
+    int rows = 0;
+    int tileWidth = 0;
+    int tileHeight = 0;
+    std::vector<cv::Rect> tiles;
+};
+
+// Fills grid in place, reusing its offset table storage between predictions
+void buildTileGrid(const cv::Size& imageSize, const TileGridConfig& config, TileGrid& grid);
+
+// Cheap occupancy test on a downsampled copy of the tile: enough non-black (dish) area and
+// at least a few edges inside it. Black background and empty agar both fail.
+bool tileHasContent(const cv::Mat& tile, const TileContentConfig& config);
+
+// Maps a model box (center format, model input coordinates) into full image coordinates,
+// clamped to the tile it came from
+cv::Rect remapTileBox(float cx, float cy, float w, float h, float scaleX, float scaleY, const cv::Rect& tile);
+
+// Merges boxes of the same class that were cut by a tile seam and detected again in the
+// neighbouring tile. Merged boxes become the union of the group with the best confidence.
+// Runs before global NMS, which can't match a clipped half of a worm against the whole one.
+void mergeCrossTileDuplicates(const TileGrid& grid, std::vector<cv::Rect>& boxes, std::vector<float>& confidences,
+    std::vector<int>& classIds, std::vector<int>& tileIds);
+
+#endif // TILING_H
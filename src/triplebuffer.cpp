@@ -0,0 +1,28 @@
+#include "triplebuffer.h"
+
+void TripleFrameBuffer::publish(const cv::Mat& frame, int64_t capturedAtMs, const cv::Size& fullSize) {
+    Slot& slot = m_slots[m_back];
+    slot.frame = frame;
+    slot.capturedAtMs = capturedAtMs;
+    slot.fullSize = fullSize;
+
+    // release: the slot contents are visible to the consumer that swaps this index in
+    const uint8_t previous = m_middle.exchange(static_cast<uint8_t>(m_back | FRESH), std::memory_order_acq_rel);
+    m_back = previous & INDEX_MASK;
+
+    m_published.fetch_add(1, std::memory_order_relaxed);
+    if (previous & FRESH) m_overwritten.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool TripleFrameBuffer::takeLatest(cv::Mat& frame, int64_t& capturedAtMs, cv::Size& fullSize) {
+    if (!(m_middle.load(std::memory_order_acquire) & FRESH)) return false;
+
+    const uint8_t previous = m_middle.exchange(m_front, std::memory_order_acq_rel);
+    m_front = previous & INDEX_MASK;
+
+    const Slot& slot = m_slots[m_front];
+    frame = slot.frame;
+    capturedAtMs = slot.capturedAtMs;
+    fullSize = slot.fullSize;
+    return true;
+}
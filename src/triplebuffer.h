@@ -0,0 +1,45 @@
+#ifndef TRIPLEBUFFER_H
+#define TRIPLEBUFFER_H
+
+#include <opencv2/core.hpp>
+
+#include <atomic>
+#include <cstdint>
+
+// Lock-free latest-frame handoff from one capture thread to the UI thread. Of three slots the camera
+// owns one (back), the UI owns one (front) and the middle one is swapped atomically: the camera fills
+// its back slot and swaps it into the middle, the UI swaps the middle into its front when it is newer.
+// Neither side ever waits for the other, frames the UI did not get to are overwritten.
+// Slots hold refcounted cv::Mat, no pixels are copied.
+class TripleFrameBuffer {
+public:
+    // producer only. frame is held by reference count, the producer must not write into it afterwards.
+    // fullSize is the resolution it was captured at, frame may be a downscaled preview of it.
+    void publish(const cv::Mat& frame, int64_t capturedAtMs, const cv::Size& fullSize);
+
+    // consumer only. True with the newest frame when one was published since the last call.
+    bool takeLatest(cv::Mat& frame, int64_t& capturedAtMs, cv::Size& fullSize);
+
+    uint64_t published() const { return m_published.load(std::memory_order_relaxed); }
+    // frames replaced in the middle slot before the consumer took them
+    uint64_t overwritten() const { return m_overwritten.load(std::memory_order_relaxed); }
+
+private:
+    struct Slot {
+        cv::Mat frame;
+        int64_t capturedAtMs = 0;
+        cv::Size fullSize;
+    };
+
+    static constexpr uint8_t INDEX_MASK = 3;
+    static constexpr uint8_t FRESH = 4; // middle slot holds a frame the consumer has not taken yet
+
+    Slot m_slots[3];
+    std::atomic<uint8_t> m_middle{ 1 };
+    uint8_t m_back = 0;  // producer's slot
+    uint8_t m_front = 2; // consumer's slot
+    std::atomic<uint64_t> m_published{ 0 };
+    std::atomic<uint64_t> m_overwritten{ 0 };
+};
+
+#endif // TRIPLEBUFFER_H
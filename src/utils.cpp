@@ -9,10 +9,15 @@
 #include <QFileInfo>
 #include <QCoreApplication>
 #include <iostream>
+#include <thread>
 
 
 static bool camDebug = false;
 static bool fpsDebug = false;
+static bool benchDebug = false;
+static bool tileDumpDebug = false;
+static bool int8Model = false;
+static bool saveOutput = false;
 
 void set_camDebug_flag(bool val) { camDebug = val; }
 bool get_camDebug_flag() { return camDebug; }
@@ -20,6 +25,18 @@ bool get_camDebug_flag() { return camDebug; }
 void set_fpsDebug_flag(bool val) { fpsDebug = val; }
 bool get_fpsDebug_flag() { return fpsDebug; }
 
+void set_benchDebug_flag(bool val) { benchDebug = val; }
+bool get_benchDebug_flag() { return benchDebug; }
+
+void set_tileDumpDebug_flag(bool val) { tileDumpDebug = val; }
+bool get_tileDumpDebug_flag() { return tileDumpDebug; }
+
+void set_int8Model_flag(bool val) { int8Model = val; }
+bool get_int8Model_flag() { return int8Model; }
+
+void set_saveOutput_flag(bool val) { saveOutput = val; }
+bool get_saveOutput_flag() { return saveOutput; }
+
 
 //Logger class
 
@@ -31,6 +31,10 @@ enum cameraIndex {
 #define END_TIMER(name) auto end_##name = std::chrono::high_resolution_clock::now(); \
                             auto duration_##name = std::chrono::duration_cast<std::chrono::milliseconds>(end_##name - start_##name); \
                             LOG_INFO("[TIMER] " << #name << ": " << duration_##name.count() << " ms")
+// same, only logs when cond holds: per-frame stages stay quiet (and allocation free) outside benchDebug
+#define END_TIMER_IF(cond, name) auto end_##name = std::chrono::high_resolution_clock::now(); \
+                            auto duration_##name = std::chrono::duration_cast<std::chrono::milliseconds>(end_##name - start_##name); \
+                            if (cond) LOG_INFO("[TIMER] " << #name << ": " << duration_##name.count() << " ms")
 
 
 // functions declarations
@@ -38,6 +42,14 @@ void set_camDebug_flag(bool val);
 bool get_camDebug_flag();
 void set_fpsDebug_flag(bool val);
 bool get_fpsDebug_flag();
+void set_benchDebug_flag(bool val);
+bool get_benchDebug_flag();
+void set_tileDumpDebug_flag(bool val);
+bool get_tileDumpDebug_flag();
+void set_int8Model_flag(bool val);
+bool get_int8Model_flag();
+void set_saveOutput_flag(bool val);
+bool get_saveOutput_flag();
 std::vector<int> checkAvailableCameraConnections();
 
 
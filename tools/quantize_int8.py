@@ -0,0 +1,130 @@
+"""Builds the INT8 (QDQ) detection model used when the int8Model flag is set.
+
+Calibrates on the macro images the app saves into macro_img/, cut into the same tile grid and
+preprocessed the same way as InferenceWorker (bilinear resize to 640x640, 1/255, CHW, channels in
+memory order), so the activation ranges match what the model sees at runtime. The app tiles RGB
+frames and saves them with cv::imwrite unswapped, so cv2.imread hands back the same RGB order the
+model gets, and the tiles are used as read.
+
+    pip install onnx onnxruntime opencv-python numpy
+    python tools/quantize_int8.py --images <app folder>/macro_img
+
+Check the result against FP32 with: Injector_app.exe --compare-models <folder>
+"""
+
+import argparse
+import math
+import os
+import random
+import tempfile
+
+import cv2
+import numpy as np
+import onnx
+from onnxruntime.quantization import (CalibrationDataReader, CalibrationMethod, QuantFormat, QuantType,
+                                      quantize_static)
+from onnxruntime.quantization.shape_inference import quant_pre_process
+
+INPUT_SIZE = 640
+IMAGE_EXTENSIONS = (".png", ".jpg", ".jpeg", ".bmp")
+
+
+def build_tile_grid(width, height, cols, rows, overlap):
+    """Same layout as buildTileGrid in src/tiling.cpp."""
+    overlap = min(max(overlap, 0.0), 0.9)
+    tile_w = min(math.ceil(width / (cols - (cols - 1) * overlap)), width)
+    tile_h = min(math.ceil(height / (rows - (rows - 1) * overlap)), height)
+    stride_x = (width - tile_w) / (cols - 1) if cols > 1 else 0.0
+    stride_y = (height - tile_h) / (rows - 1) if rows > 1 else 0.0
+    # std::lround rounds halves up, Python's round() would not
+    return [(math.floor(c * stride_x + 0.5), math.floor(r * stride_y + 0.5), tile_w, tile_h)
+            for r in range(rows) for c in range(cols)]
+
+
+def tile_has_content(tile, downsample=8, dark=10, min_foreground=0.02, edge=12, min_edges=3):
+    """Same test as tileHasContent in src/tiling.cpp, empty tiles never reach the model at runtime.
+    Tiles are RGB, as at runtime."""
+    small = cv2.resize(tile, None, fx=1.0 / downsample, fy=1.0 / downsample, interpolation=cv2.INTER_AREA)
+    gray = cv2.cvtColor(small, cv2.COLOR_RGB2GRAY).astype(np.int32)
+    if gray.shape[0] < 2 or gray.shape[1] < 2:
+        return True
+    v = gray[:-1, :-1]
+    foreground = v > dark
+    step = np.maximum(np.abs(gray[:-1, 1:] - v), np.abs(gray[1:, :-1] - v))
+    edges = np.count_nonzero(foreground & (step > edge))
+    return foreground.mean() >= min_foreground and edges >= min_edges
+
+
+def preprocess(tile):
+    resized = cv2.resize(tile, (INPUT_SIZE, INPUT_SIZE), interpolation=cv2.INTER_LINEAR)
+    return (resized.astype(np.float32) / 255.0).transpose(2, 0, 1)[np.newaxis]
+
+
+class TileReader(CalibrationDataReader):
+    def __init__(self, input_name, tiles):
+        self.input_name = input_name
+        self.tiles = iter(tiles)
+
+    def get_next(self):
+        tile = next(self.tiles, None)
+        return None if tile is None else {self.input_name: preprocess(tile)}
+
+
+def collect_tiles(folder, cols, rows, overlap, max_tiles):
+    paths = sorted(os.path.join(folder, f) for f in os.listdir(folder) if f.lower().endswith(IMAGE_EXTENSIONS))
+    tiles = []
+    for path in paths:
+        image = cv2.imread(path)
+        if image is None:
+            print(f"skipping unreadable {path}")
+            continue
+        height, width = image.shape[:2]
+        for x, y, w, h in build_tile_grid(width, height, cols, rows, overlap):
+            tile = image[y:y + h, x:x + w]
+            if tile_has_content(tile):
+                tiles.append(tile)
+
+    # spread the sample over all images instead of taking the first ones
+    random.Random(0).shuffle(tiles)
+    return paths, tiles[:max_tiles]
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--model", default="deps/models/yolo12n_DynamicAxis.onnx")
+    parser.add_argument("--output", default="deps/models/yolo12n_DynamicAxis_int8_qdq.onnx")
+    parser.add_argument("--images", default="macro_img", help="folder of saved macro images")
+    parser.add_argument("--grid", default="4x4", help="tile grid, cols x rows, as set in the UI")
+    parser.add_argument("--overlap", type=float, default=0.1)
+    parser.add_argument("--max-tiles", type=int, default=256, help="calibration sample size")
+    parser.add_argument("--method", choices=["minmax", "entropy", "percentile"], default="percentile")
+    args = parser.parse_args()
+
+    cols, rows = (int(v) for v in args.grid.lower().split("x"))
+    paths, tiles = collect_tiles(args.images, cols, rows, args.overlap, args.max_tiles)
+    if not tiles:
+        raise SystemExit(f"no usable calibration tiles in {args.images}")
+    print(f"calibrating on {len(tiles)} tiles from {len(paths)} images")
+
+    with tempfile.TemporaryDirectory() as tmp:
+        # shape inference + graph cleanup first, as recommended for static quantization
+        prepared = os.path.join(tmp, "prepared.onnx")
+        quant_pre_process(args.model, prepared)
+
+        input_name = onnx.load(prepared).graph.input[0].name
+        methods = {"minmax": CalibrationMethod.MinMax, "entropy": CalibrationMethod.Entropy,
+                   "percentile": CalibrationMethod.Percentile}
+
+        # uint8 activations / int8 per-channel weights is the combination ORT's CPU kernels are tuned for
+        quantize_static(prepared, args.output, TileReader(input_name, tiles),
+                        quant_format=QuantFormat.QDQ,
+                        activation_type=QuantType.QUInt8,
+                        weight_type=QuantType.QInt8,
+                        per_channel=True,
+                        calibrate_method=methods[args.method])
+
+    print(f"wrote {args.output}")
+
+
+if __name__ == "__main__":
+    main()